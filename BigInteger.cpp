@@ -2,39 +2,322 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <deque>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <thread>
+#include <future>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BIGINTEGER_X86_SIMD 1
+#endif
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define BIGINTEGER_BIG_ENDIAN 1
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define BIGINTEGER_MMAP 1
+#endif
+
+class LimbVector {
+ public:
+  static const size_t INLINE_CAPACITY = 4;
+  LimbVector(): sz(0), cap(INLINE_CAPACITY) {}
+  explicit LimbVector(size_t n): LimbVector() { resize(n); }
+  LimbVector(const uint32_t* first, const uint32_t* last): LimbVector() { assign(first, last); }
+  LimbVector(const LimbVector& other): LimbVector() { assign(other.begin(), other.end()); }
+  LimbVector(LimbVector&& other) noexcept: sz(other.sz), cap(other.cap) {
+    if (other.isInline()) {
+      memcpy(local, other.local, sz * sizeof(uint32_t));
+    } else {
+      heap = other.heap;
+      other.cap = INLINE_CAPACITY;
+    }
+    other.sz = 0;
+  }
+  LimbVector& operator=(const LimbVector& other) {
+    if (this != &other) { assign(other.begin(), other.end()); }
+    return *this;
+  }
+  LimbVector& operator=(LimbVector&& other) noexcept {
+    if (this == &other) { return *this; }
+    if (other.isInline()) {
+      assign(other.begin(), other.end());
+    } else {
+      if (!isInline()) { delete[] heap; }
+      heap = other.heap;
+      sz = other.sz;
+      cap = other.cap;
+      other.cap = INLINE_CAPACITY;
+    }
+    other.sz = 0;
+    return *this;
+  }
+  ~LimbVector() {
+    if (!isInline()) { delete[] heap; }
+  }
+  size_t size() const { return sz; }
+  bool empty() const { return sz == 0; }
+  uint32_t* data() { return isInline() ? local : heap; }
+  const uint32_t* data() const { return isInline() ? local : heap; }
+  uint32_t* begin() { return data(); }
+  uint32_t* end() { return data() + sz; }
+  const uint32_t* begin() const { return data(); }
+  const uint32_t* end() const { return data() + sz; }
+  uint32_t& operator[](size_t i) { return data()[i]; }
+  const uint32_t& operator[](size_t i) const { return data()[i]; }
+  uint32_t& back() { return data()[sz - 1]; }
+  const uint32_t& back() const { return data()[sz - 1]; }
+  void reserve(size_t n) {
+    if (n <= cap) { return; }
+    size_t new_cap = std::max(n, 2 * cap);
+    uint32_t* tmp = new uint32_t[new_cap];
+    std::copy(begin(), end(), tmp);
+    if (!isInline()) { delete[] heap; }
+    heap = tmp;
+    cap = new_cap;
+  }
+  void resize(size_t n) {
+    reserve(n);
+    if (n > sz) { memset(data() + sz, 0, (n - sz) * sizeof(uint32_t)); }
+    sz = n;
+  }
+  void push_back(uint32_t x) {
+    reserve(sz + 1);
+    data()[sz++] = x;
+  }
+  void pop_back() { --sz; }
+  void assign(const uint32_t* first, const uint32_t* last) {
+    size_t n = last - first;
+    reserve(n);
+    std::copy(first, last, data());
+    sz = n;
+  }
+  void assign(size_t n, uint32_t value) {
+    reserve(n);
+    std::fill(data(), data() + n, value);
+    sz = n;
+  }
+  void insert(const uint32_t* pos, size_t count, uint32_t value) {
+    size_t index = pos - data();
+    reserve(sz + count);
+    memmove(data() + index + count, data() + index, (sz - index) * sizeof(uint32_t));
+    std::fill(data() + index, data() + index + count, value);
+    sz += count;
+  }
+  void erase(const uint32_t* first, const uint32_t* last) {
+    size_t index = first - data(), count = last - first;
+    memmove(data() + index, data() + index + count, (sz - index - count) * sizeof(uint32_t));
+    sz -= count;
+  }
+ private:
+  size_t sz;
+  size_t cap;
+  union {
+    uint32_t* heap;
+    uint32_t local[INLINE_CAPACITY];
+  };
+  bool isInline() const { return cap == INLINE_CAPACITY; }
+};
+
+bool operator==(const LimbVector& a, const LimbVector& b) {
+  return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+// Fork-join helper: runs a task on a new thread while fewer tasks than spare hardware
+// threads are in flight, and inline otherwise. The returned future must be joined with
+// get(), which rethrows anything the task threw, before anything the task refers to goes
+// out of scope.
+class ForkJoin {
+ public:
+  static std::future<void> fork(std::function<void()> task) {
+    if (spare().fetch_sub(1) > 0) {
+      return std::async(std::launch::async, [task] {
+        SpareThread release;
+        task();
+      });
+    }
+    ++spare();
+    std::promise<void> done;
+    try {
+      task();
+      done.set_value();
+    } catch (...) {
+      done.set_exception(std::current_exception());
+    }
+    return done.get_future();
+  }
+ private:
+  // Gives the thread slot back even when the task throws.
+  struct SpareThread {
+    ~SpareThread() { ++spare(); }
+  };
+  static std::atomic<int>& spare() {
+    static std::atomic<int> threads(static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) - 1);
+    return threads;
+  }
+};
 
 class BigInteger;
+BigInteger operator+(const BigInteger&, const BigInteger&);
+BigInteger operator+(BigInteger&&, const BigInteger&);
+BigInteger operator+(const BigInteger&, BigInteger&&);
+BigInteger operator+(BigInteger&&, BigInteger&&);
+BigInteger operator-(const BigInteger&, const BigInteger&);
+BigInteger operator-(BigInteger&&, const BigInteger&);
+BigInteger operator-(const BigInteger&, BigInteger&&);
+BigInteger operator-(BigInteger&&, BigInteger&&);
 BigInteger operator*(const BigInteger&, const BigInteger&);
+BigInteger operator*(BigInteger&&, const BigInteger&);
+BigInteger operator*(const BigInteger&, BigInteger&&);
+BigInteger operator*(BigInteger&&, BigInteger&&);
 BigInteger operator/(const BigInteger&, const BigInteger&);
-void plus(std::vector<long long>&, const std::vector<long long>&, long long);
-void minus(std::vector<long long>&, const std::vector<long long>&, long long);
-bool less(const std::vector<long long>&, const std::vector<long long>&);
+std::pair<BigInteger, BigInteger> divmod(const BigInteger&, const BigInteger&);
+void addmul(BigInteger&, const BigInteger&, const BigInteger&);
+void submul(BigInteger&, const BigInteger&, const BigInteger&);
+BigInteger gcd(BigInteger, BigInteger);
+BigInteger lcm(const BigInteger&, const BigInteger&);
+BigInteger extendedGcd(BigInteger, BigInteger, BigInteger&, BigInteger&);
+BigInteger pow(BigInteger, unsigned long long);
+BigInteger powmod(const BigInteger&, const BigInteger&, const BigInteger&);
+std::ostream& writeBinary(std::ostream&, const BigInteger&);
+std::istream& readBinary(std::istream&, BigInteger&);
+BigInteger iroot(const BigInteger&, int);
+BigInteger isqrt(const BigInteger&);
+void plus(LimbVector&, const LimbVector&);
+void minus(LimbVector&, const LimbVector&);
+bool less(const LimbVector&, const LimbVector&);
 
 class BigInteger {
   friend bool operator<(const BigInteger&, const BigInteger&);
   friend bool operator==(const BigInteger&, const BigInteger&);
+  friend class Rational;
+  friend class MontgomeryContext;
+  friend class BigIntegerArrayView;
+  friend class BigVector;
+  friend struct MultiplyBenchmark;
+  friend std::ostream& writeBinary(std::ostream&, const BigInteger&);
+  friend std::istream& readBinary(std::istream&, BigInteger&);
+  friend BigInteger powmod(const BigInteger&, const BigInteger&, const BigInteger&);
+  friend BigInteger iroot(const BigInteger&, int);
+  friend std::pair<BigInteger, BigInteger> divmod(const BigInteger&, const BigInteger&);
+  friend void addmul(BigInteger&, const BigInteger&, const BigInteger&);
+  friend void submul(BigInteger&, const BigInteger&, const BigInteger&);
+  friend BigInteger gcd(BigInteger, BigInteger);
+  friend BigInteger extendedGcd(BigInteger, BigInteger, BigInteger&, BigInteger&);
+  friend void plus(LimbVector&, const LimbVector&);
+  friend void minus(LimbVector&, const LimbVector&);
+  friend bool less(const LimbVector&, const LimbVector&);
  private:
-  static const long long MOD = 1'000'000'000;
-  static const int LOGMOD = 9;
+  static const uint64_t BASE = 1ull << 32;
+  static const int LIMB_BITS = 32;
+  static const uint32_t DECIMAL_BASE = 1'000'000'000;
+  static const int DECIMAL_DIGITS = 9;
+  static const int KARATSUBA_THRESHOLD = 40;
+  static const int KARATSUBA_FORK_THRESHOLD = 1000;
+  static const int TOOM3_THRESHOLD = 8000;
+  static const int NTT_THRESHOLD = 7000;
+  static const int NTT_MAX_LENGTH = 1 << 23;
+  static const long long NTT_PRIME_0 = 998'244'353;
+  static const long long NTT_PRIME_1 = 167'772'161;
+  static const long long NTT_PRIME_2 = 469'762'049;
+  static const long long NTT_ROOT = 3;
+  static const int NEWTON_THRESHOLD = 1000;
+  static const int NEWTON_BASE = 32;
+  static const int CONVERSION_THRESHOLD = 40;
+  static const int SIMD_THRESHOLD = 32;
+  static const int64_t LEHMER_COFACTOR_LIMIT = 1 << 30;
   void removeLeadZeroes() {
     while (digits.size() > 1 && digits.back() == 0) { digits.pop_back(); }
     if (digits.size() == 1 && digits.back() == 0) { sign = 0; }
   }
   int sign;
-  std::vector<long long> digits;
-  void levelUp(long long x) {
-    digits.push_back(0);
-    for (int i = static_cast<int>(digits.size()) - 1; i >= 1; --i) {
-      if (digits[i - 1]) { sign = 1; }
-      digits[i] = digits[i - 1];
-    }
-    digits[0] = x;
-    if (x) { sign = 1; }
-    removeLeadZeroes();
-  }
+  LimbVector digits;
+  BigInteger slice(int from, int count) const;
+  void shiftLimbs(int k);
+  void shiftBits(int k);
+  bool lowBitsZero(int k) const;
+  void divideSmall(uint32_t d);
+  using CarryKernel = uint32_t (*)(const uint32_t* x, const uint32_t* y, uint32_t* out, int n, uint32_t carry);
+  using CompareKernel = int (*)(const uint32_t* a, const uint32_t* b, int n);
+  struct LimbKernels {
+    CarryKernel add;
+    CarryKernel sub;
+    CompareKernel compare;
+  };
+  static const LimbKernels& kernels();
+  static uint32_t addScalar(const uint32_t* x, const uint32_t* y, uint32_t* out, int n, uint32_t carry);
+  static uint32_t subScalar(const uint32_t* x, const uint32_t* y, uint32_t* out, int n, uint32_t borrow);
+  static int compareScalar(const uint32_t* a, const uint32_t* b, int n);
+#ifdef BIGINTEGER_X86_SIMD
+  static uint32_t addSse4(const uint32_t* x, const uint32_t* y, uint32_t* out, int n, uint32_t carry);
+  static uint32_t subSse4(const uint32_t* x, const uint32_t* y, uint32_t* out, int n, uint32_t borrow);
+  static int compareSse4(const uint32_t* a, const uint32_t* b, int n);
+  static uint32_t addAvx2(const uint32_t* x, const uint32_t* y, uint32_t* out, int n, uint32_t carry);
+  static uint32_t subAvx2(const uint32_t* x, const uint32_t* y, uint32_t* out, int n, uint32_t borrow);
+  static int compareAvx2(const uint32_t* a, const uint32_t* b, int n);
+#endif
+  static uint32_t addLimbs(const uint32_t* x, const uint32_t* y, uint32_t* out, int n);
+  static uint32_t subLimbs(const uint32_t* x, const uint32_t* y, uint32_t* out, int n);
+  static int compareLimbs(const uint32_t* a, const uint32_t* b, int n);
+  static uint32_t addTo(uint32_t* a, int n, const uint32_t* b, int m);
+  static uint32_t subFrom(uint32_t* a, int n, const uint32_t* b, int m);
+  static void subReversed(uint32_t* a, const uint32_t* b, int n);
+  static uint32_t mulSmall(uint32_t* a, int n, uint32_t x);
+  static uint32_t addMulSmall(uint32_t* a, const uint32_t* b, int n, uint32_t x);
+  static uint32_t divSmall(uint32_t* a, int n, uint32_t x);
+  static void mulSchoolbook(const uint32_t* a, int n, const uint32_t* b, int m, uint32_t* res);
+  static int karatsubaScratch(int n);
+  static void mulKaratsuba(const uint32_t* a, const uint32_t* b, int n, uint32_t* res, uint32_t* scratch);
+  static void multiply(const uint32_t* a, int n, const uint32_t* b, int m, uint32_t* res);
+  static void multiplyMagnitudes(const BigInteger& a, const BigInteger& b, LimbVector& res);
+  static BigInteger toomCook3(const BigInteger& a, const BigInteger& b);
+  static long long powMod(long long x, long long p, long long mod);
+  template <long long P>
+  static void ntt(std::vector<long long>& a, bool invert);
+  template <long long P>
+  static void convolve(const LimbVector& a, const LimbVector& b, bool square,
+                       std::vector<long long>& res);
+  static LimbVector multiplyNtt(const LimbVector& a, const LimbVector& b);
+  static void divmodKnuth(const LimbVector& a, const LimbVector& b,
+                          LimbVector& quotient, LimbVector& remainder);
+  static BigInteger reciprocal(const BigInteger& v);
+  static void correctDivision(BigInteger& q, BigInteger& r, const BigInteger& b);
+  static std::pair<BigInteger, BigInteger> divmodNewton(const BigInteger& a, const BigInteger& b);
+  static void divmodTo(const BigInteger& a, const BigInteger& b, BigInteger& quotient, BigInteger& remainder);
+  static std::pair<BigInteger, BigInteger> divmodByReciprocal(const BigInteger& a, const BigInteger& b,
+                                                              const BigInteger& inv);
+  static const BigInteger& decimalPower(int level);
+  static const BigInteger& decimalReciprocal(int level);
+  static int decimalLevel(int limbs);
+  static BigInteger parseDecimal(const char* s, int len);
+  void appendDecimal(std::string& out, int width) const;
+  static BigInteger fromWord(uint64_t x);
+  static BigInteger fromLimbs(const uint32_t* limbs, int n);
+  static double ratioToDouble(const BigInteger& num, const BigInteger& den);
+  uint64_t leadingBits(int shift) const;
+  static uint64_t binaryGcd(uint64_t a, uint64_t b);
+  static void combineLimbs(LimbVector& a, LimbVector& b, int64_t u0, int64_t v0, int64_t u1, int64_t v1);
+  static void lehmerReduce(BigInteger& a, BigInteger& b, BigInteger* x0, BigInteger* x1);
+  BigInteger& addSigned(const LimbVector& other, int other_sign);
+  void addProduct(const BigInteger& b, const BigInteger& c, int product_sign);
  public:
   int size() const { return static_cast<int>(digits.size()); }
   int sgn() const { return sign; }
+  int bitLength() const {
+    if (sign == 0) { return 0; }
+    return (size() - 1) * LIMB_BITS + (LIMB_BITS - __builtin_clz(digits.back()));
+  }
   BigInteger abs() const {
     if (sign == -1) { return -*this; }
     return *this;
@@ -42,10 +325,10 @@ class BigInteger {
   BigInteger(long long n) {
     if (n) {
       sign = (n > 0 ? 1 : -1);
-      if (n < 0) { n *= -1; }
-      while (n > 0) {
-        digits.push_back(n % MOD);
-        n /= MOD;
+      uint64_t magnitude = n > 0 ? n : 0ull - static_cast<uint64_t>(n);
+      while (magnitude > 0) {
+        digits.push_back(static_cast<uint32_t>(magnitude));
+        magnitude >>= LIMB_BITS;
       }
     } else {
       sign = 0;
@@ -53,97 +336,52 @@ class BigInteger {
     }
   }
   BigInteger(): BigInteger(0) {}
+  // Decimal digits with an optional leading '-'; anything else throws std::invalid_argument.
   BigInteger(const std::string& s) {
-    sign = 1;
-    int st = 0;
-    if (s[0] == '-') {
-      sign = -1;
-      st = 1;
-    }
-    if (s[st] == '0') { sign = 0; }
-    for (int i = static_cast<int>(s.length()); i > st; i -= LOGMOD) {
-      if (i < LOGMOD + st) { digits.push_back(stoi(s.substr(st, i - st))); }
-      else { digits.push_back(stoi(s.substr(i - LOGMOD, LOGMOD))); }
+    size_t st = !s.empty() && s[0] == '-' ? 1 : 0;
+    if (s.size() == st || s.find_first_not_of("0123456789", st) != std::string::npos) {
+      throw std::invalid_argument("BigInteger: not a decimal integer: \"" + s + "\"");
     }
+    *this = parseDecimal(s.data() + st, static_cast<int>(s.length()) - st);
+    if (st) { changeSign(); }
   }
   explicit operator bool() const { return sign != 0; }
   void changeSign() { sign *= -1; }
-  BigInteger& operator+=(const BigInteger& other) {
-    if (sign * other.sign >= 0) {
-      plus(digits, other.digits, MOD);
-      removeLeadZeroes();
-      return *this;
-    }
-    if (!less(digits, other.digits)) {
-      minus(digits, other.digits, MOD);
-    } else {
-      std::vector<long long> tmp = other.digits;
-      minus(tmp, digits, MOD);
-      digits = tmp;
-      changeSign();
-    }
-    removeLeadZeroes();
+  BigInteger& operator+=(const BigInteger& other) { return addSigned(other.digits, other.sign); }
+  BigInteger& operator-=(const BigInteger& other) { return addSigned(other.digits, -other.sign); }
+  BigInteger& operator*=(const BigInteger& other) {
+    int res_sign = sign * other.sign;
+    if (res_sign == 0) { return *this = 0; }
+    thread_local LimbVector product;
+    multiplyMagnitudes(*this, other, product);
+    std::swap(digits, product);
+    sign = res_sign;
     return *this;
   }
-  BigInteger& operator-=(const BigInteger& other) {
-    return *this += (-other);
+  BigInteger& operator/=(const BigInteger& other) {
+    thread_local BigInteger remainder;
+    divmodTo(*this, other, *this, remainder);
+    return *this;
   }
-  BigInteger& operator*=(const BigInteger& other) {
-    sign *= other.sign;
-    std::vector<long long> res(digits.size() + other.size() + 1);
-    for (int i = 0; i < static_cast<int>(digits.size()); ++i) {
-      long long carry = 0;
-      for (int j = 0; j < other.size() || carry; ++j) {
-        long long cur = res[i + j] + digits[i] * (j < other.size() ? other.digits[j] : 0) + carry;
-        res[i + j] = cur % MOD;
-        carry = cur / MOD;
-      }
-    }
-    digits = res;
-    removeLeadZeroes();
+  BigInteger& operator%=(const BigInteger& other) {
+    thread_local BigInteger quotient;
+    divmodTo(*this, other, quotient, *this);
     return *this;
   }
-  BigInteger& operator/=(const BigInteger& other) {
-    if (sign == 0) { return *this; }
-    BigInteger mod_a = abs(), mod_b = other.abs();
-    if (mod_a < mod_b) return *this = 0;
-    std::vector<long long> tmp;
-    BigInteger cur;
-    int i = static_cast<int>(digits.size()) - 1;
-    while (i >= 0) {
-      if (cur == 0) {
-        while (i >= 0 && !digits[i]) {
-          --i;
-          tmp.push_back(0);
-        }
-      }
-      if (i >= 0) {
-        int cnt = 0;
-        while (i >= 0 && cur < mod_b) {
-          cur.levelUp(mod_a.digits[i--]);
-          ++cnt;
-          if (cnt > 1) { tmp.push_back(0); }
-        }
-        long long l = 0, r = MOD;
-        while (r - l > 1) {
-          long long m = (l + r) / 2;
-          if (cur < mod_b * m) {
-            r = m;
-          } else {
-            l = m;
-          }
-        }
-        tmp.push_back(l);
-        cur -= mod_b * l;
-      }
-    }
-    std::reverse(tmp.begin(), tmp.end());
-    digits = tmp;
-    sign *= other.sign;
-    removeLeadZeroes();
+  // A negative count shifts the other way; it is split as -(k + 1) and 1 so that INT_MIN
+  // does not overflow.
+  BigInteger& operator<<=(int k) {
+    if (k < 0) { return (*this >>= -(k + 1)) >>= 1; }
+    shiftBits(k);
+    return *this;
+  }
+  BigInteger& operator>>=(int k) {
+    if (k < 0) { return (*this <<= -(k + 1)) <<= 1; }
+    bool round_down = sign < 0 && !lowBitsZero(k);
+    shiftBits(-k);
+    if (round_down) { *this -= 1; }
     return *this;
   }
-  BigInteger& operator%=(const BigInteger& other) { return *this -= other * (*this / other); }
   BigInteger& operator++() { return *this += 1; }
   BigInteger operator++(int) {
     BigInteger tmp = *this;
@@ -156,43 +394,1164 @@ class BigInteger {
     --(*this);
     return tmp;
   }
-  BigInteger operator-() const {
+  BigInteger operator-() const& {
     BigInteger tmp = *this;
     tmp.changeSign();
     return tmp;
   }
+  BigInteger operator-() && {
+    changeSign();
+    return std::move(*this);
+  }
   BigInteger operator+() const {
     BigInteger tmp = *this;
     return tmp;
   }
   std::string toString() const {
     std::string ans;
+    ans.reserve(size() * 10 + 1);
     if (sign == -1) {
       ans += '-';
-    }
-    ans += std::to_string(digits.back());
-    for (int i = static_cast<int>(digits.size()) - 2; i >= 0; --i) {
-      std::string tmp = std::to_string(digits[i]);
-      for (int j = 0; j < static_cast<int>(LOGMOD - tmp.length()); ++j) {
-        ans += '0';
-      }
-      ans += tmp;
+      abs().appendDecimal(ans, 0);
+    } else {
+      appendDecimal(ans, 0);
     }
     return ans;
   }
 };
 
+BigInteger BigInteger::slice(int from, int count) const {
+  BigInteger res;
+  if (from >= size()) { return res; }
+  count = std::min(count, size() - from);
+  res.digits.assign(digits.begin() + from, digits.begin() + from + count);
+  res.sign = 1;
+  res.removeLeadZeroes();
+  return res;
+}
+void BigInteger::shiftLimbs(int k) {
+  if (sign == 0 || k == 0) { return; }
+  if (k > 0) {
+    digits.insert(digits.begin(), k, 0);
+  } else if (-k >= size()) {
+    *this = 0;
+  } else {
+    digits.erase(digits.begin(), digits.begin() - k);
+  }
+}
+void BigInteger::shiftBits(int k) {
+  if (sign == 0 || k == 0) { return; }
+  int bits = std::abs(k) % LIMB_BITS;
+  if (k > 0) {
+    if (bits) {
+      uint32_t carry = 0;
+      for (uint32_t& limb : digits) {
+        uint32_t next = limb >> (LIMB_BITS - bits);
+        limb = limb << bits | carry;
+        carry = next;
+      }
+      if (carry) { digits.push_back(carry); }
+    }
+    shiftLimbs(k / LIMB_BITS);
+    return;
+  }
+  shiftLimbs(k / LIMB_BITS);
+  if (sign == 0 || bits == 0) { return; }
+  for (int i = 0; i < size(); ++i) {
+    digits[i] = digits[i] >> bits | (i + 1 < size() ? digits[i + 1] << (LIMB_BITS - bits) : 0);
+  }
+  removeLeadZeroes();
+}
+bool BigInteger::lowBitsZero(int k) const {
+  int limbs = std::min(k / LIMB_BITS, size()), bits = k % LIMB_BITS;
+  for (int i = 0; i < limbs; ++i) {
+    if (digits[i]) { return false; }
+  }
+  return limbs == size() || bits == 0 || (digits[limbs] & ((1u << bits) - 1)) == 0;
+}
+void BigInteger::divideSmall(uint32_t d) {
+  divSmall(digits.data(), size(), d);
+  removeLeadZeroes();
+}
+uint32_t BigInteger::addScalar(const uint32_t* x, const uint32_t* y, uint32_t* out, int n, uint32_t carry) {
+  uint64_t acc = carry;
+  for (int i = 0; i < n; ++i) {
+    acc += static_cast<uint64_t>(x[i]) + y[i];
+    out[i] = static_cast<uint32_t>(acc);
+    acc >>= LIMB_BITS;
+  }
+  return static_cast<uint32_t>(acc);
+}
+uint32_t BigInteger::subScalar(const uint32_t* x, const uint32_t* y, uint32_t* out, int n, uint32_t borrow) {
+  uint64_t acc = borrow;
+  for (int i = 0; i < n; ++i) {
+    acc = static_cast<uint64_t>(x[i]) - y[i] - acc;
+    out[i] = static_cast<uint32_t>(acc);
+    acc >>= 63;
+  }
+  return static_cast<uint32_t>(acc);
+}
+int BigInteger::compareScalar(const uint32_t* a, const uint32_t* b, int n) {
+  for (int i = n - 1; i >= 0; --i) {
+    if (a[i] != b[i]) { return a[i] < b[i] ? -1 : 1; }
+  }
+  return 0;
+}
+#ifdef BIGINTEGER_X86_SIMD
+// Vector add/sub: every lane is added independently, then the lanes that generate a carry
+// (overflowed) and those that propagate one (all ones for add, zero for sub) are packed
+// into bitmasks, and a single integer addition ((g << 1 | c) + p) ^ p tells which lanes
+// receive a carry.
+__attribute__((target("sse4.1")))
+uint32_t BigInteger::addSse4(const uint32_t* x, const uint32_t* y, uint32_t* out, int n, uint32_t carry) {
+  const __m128i ones = _mm_set1_epi32(-1);
+  const __m128i lane_bits = _mm_setr_epi32(1, 2, 4, 8);
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i));
+    __m128i s = _mm_add_epi32(a, b);
+    unsigned generate = ~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_max_epu32(s, a), s))) & 0xF;
+    unsigned propagate = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(s, ones)));
+    unsigned carries = ((generate << 1 | carry) + propagate) ^ propagate;
+    carry = carries >> 4;
+    __m128i mask = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(carries), lane_bits), lane_bits);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_sub_epi32(s, mask));
+  }
+  return addScalar(x + i, y + i, out + i, n - i, carry);
+}
+__attribute__((target("sse4.1")))
+uint32_t BigInteger::subSse4(const uint32_t* x, const uint32_t* y, uint32_t* out, int n, uint32_t borrow) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i lane_bits = _mm_setr_epi32(1, 2, 4, 8);
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i));
+    __m128i d = _mm_sub_epi32(a, b);
+    unsigned generate = ~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_max_epu32(a, b), a))) & 0xF;
+    unsigned propagate = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(d, zero)));
+    unsigned borrows = ((generate << 1 | borrow) + propagate) ^ propagate;
+    borrow = borrows >> 4;
+    __m128i mask = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(borrows), lane_bits), lane_bits);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi32(d, mask));
+  }
+  return subScalar(x + i, y + i, out + i, n - i, borrow);
+}
+__attribute__((target("sse4.1")))
+int BigInteger::compareSse4(const uint32_t* a, const uint32_t* b, int n) {
+  int i = n;
+  for (; i >= 4; i -= 4) {
+    __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i - 4));
+    __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i - 4));
+    unsigned differ = ~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(va, vb))) & 0xF;
+    if (differ) {
+      int j = i - 4 + 31 - __builtin_clz(differ);
+      return a[j] < b[j] ? -1 : 1;
+    }
+  }
+  return compareScalar(a, b, i);
+}
+__attribute__((target("avx2")))
+uint32_t BigInteger::addAvx2(const uint32_t* x, const uint32_t* y, uint32_t* out, int n, uint32_t carry) {
+  const __m256i ones = _mm256_set1_epi32(-1);
+  const __m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i));
+    __m256i s = _mm256_add_epi32(a, b);
+    unsigned generate = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_max_epu32(s, a), s))) & 0xFF;
+    unsigned propagate = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(s, ones)));
+    unsigned carries = ((generate << 1 | carry) + propagate) ^ propagate;
+    carry = carries >> 8;
+    __m256i mask = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(carries), lane_bits), lane_bits);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_sub_epi32(s, mask));
+  }
+  return addScalar(x + i, y + i, out + i, n - i, carry);
+}
+__attribute__((target("avx2")))
+uint32_t BigInteger::subAvx2(const uint32_t* x, const uint32_t* y, uint32_t* out, int n, uint32_t borrow) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i));
+    __m256i d = _mm256_sub_epi32(a, b);
+    unsigned generate = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_max_epu32(a, b), a))) & 0xFF;
+    unsigned propagate = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(d, zero)));
+    unsigned borrows = ((generate << 1 | borrow) + propagate) ^ propagate;
+    borrow = borrows >> 8;
+    __m256i mask = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(borrows), lane_bits), lane_bits);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi32(d, mask));
+  }
+  return subScalar(x + i, y + i, out + i, n - i, borrow);
+}
+__attribute__((target("avx2")))
+int BigInteger::compareAvx2(const uint32_t* a, const uint32_t* b, int n) {
+  int i = n;
+  for (; i >= 8; i -= 8) {
+    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i - 8));
+    __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i - 8));
+    unsigned differ = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(va, vb))) & 0xFF;
+    if (differ) {
+      int j = i - 8 + 31 - __builtin_clz(differ);
+      return a[j] < b[j] ? -1 : 1;
+    }
+  }
+  return compareScalar(a, b, i);
+}
+#endif
+const BigInteger::LimbKernels& BigInteger::kernels() {
+  static const LimbKernels selected = [] {
+#ifdef BIGINTEGER_X86_SIMD
+    if (__builtin_cpu_supports("avx2")) { return LimbKernels{addAvx2, subAvx2, compareAvx2}; }
+    if (__builtin_cpu_supports("sse4.1")) { return LimbKernels{addSse4, subSse4, compareSse4}; }
+#endif
+    return LimbKernels{addScalar, subScalar, compareScalar};
+  }();
+  return selected;
+}
+uint32_t BigInteger::addLimbs(const uint32_t* x, const uint32_t* y, uint32_t* out, int n) {
+  return n < SIMD_THRESHOLD ? addScalar(x, y, out, n, 0) : kernels().add(x, y, out, n, 0);
+}
+uint32_t BigInteger::subLimbs(const uint32_t* x, const uint32_t* y, uint32_t* out, int n) {
+  return n < SIMD_THRESHOLD ? subScalar(x, y, out, n, 0) : kernels().sub(x, y, out, n, 0);
+}
+int BigInteger::compareLimbs(const uint32_t* a, const uint32_t* b, int n) {
+  return n < SIMD_THRESHOLD ? compareScalar(a, b, n) : kernels().compare(a, b, n);
+}
+uint32_t BigInteger::addTo(uint32_t* a, int n, const uint32_t* b, int m) {
+  uint32_t carry = addLimbs(a, b, a, m);
+  for (int i = m; carry && i < n; ++i) {
+    carry = ++a[i] == 0;
+  }
+  return carry;
+}
+uint32_t BigInteger::subFrom(uint32_t* a, int n, const uint32_t* b, int m) {
+  uint32_t borrow = subLimbs(a, b, a, m);
+  for (int i = m; borrow && i < n; ++i) {
+    borrow = a[i]-- == 0;
+  }
+  return borrow;
+}
+void BigInteger::subReversed(uint32_t* a, const uint32_t* b, int n) {
+  subLimbs(b, a, a, n);
+}
+uint32_t BigInteger::mulSmall(uint32_t* a, int n, uint32_t x) {
+  uint64_t carry = 0;
+  for (int i = 0; i < n; ++i) {
+    carry += static_cast<uint64_t>(a[i]) * x;
+    a[i] = static_cast<uint32_t>(carry);
+    carry >>= LIMB_BITS;
+  }
+  return static_cast<uint32_t>(carry);
+}
+uint32_t BigInteger::addMulSmall(uint32_t* a, const uint32_t* b, int n, uint32_t x) {
+  uint64_t carry = 0;
+  for (int i = 0; i < n; ++i) {
+    carry += static_cast<uint64_t>(b[i]) * x + a[i];
+    a[i] = static_cast<uint32_t>(carry);
+    carry >>= LIMB_BITS;
+  }
+  return static_cast<uint32_t>(carry);
+}
+uint32_t BigInteger::divSmall(uint32_t* a, int n, uint32_t x) {
+  uint64_t rem = 0;
+  for (int i = n - 1; i >= 0; --i) {
+    uint64_t cur = rem << LIMB_BITS | a[i];
+    a[i] = static_cast<uint32_t>(cur / x);
+    rem = cur % x;
+  }
+  return static_cast<uint32_t>(rem);
+}
+void BigInteger::mulSchoolbook(const uint32_t* a, int n, const uint32_t* b, int m, uint32_t* res) {
+  std::fill(res, res + n + m, 0);
+  for (int i = 0; i < n; ++i) {
+    uint64_t carry = 0;
+    for (int j = 0; j < m; ++j) {
+      carry += static_cast<uint64_t>(a[i]) * b[j] + res[i + j];
+      res[i + j] = static_cast<uint32_t>(carry);
+      carry >>= LIMB_BITS;
+    }
+    res[i + m] = static_cast<uint32_t>(carry);
+  }
+}
+int BigInteger::karatsubaScratch(int n) {
+  if (n < KARATSUBA_THRESHOLD) { return 0; }
+  int h = n - n / 2;
+  return 4 * (h + 1) + karatsubaScratch(h + 1);
+}
+void BigInteger::mulKaratsuba(const uint32_t* a, const uint32_t* b, int n, uint32_t* res, uint32_t* scratch) {
+  if (n < KARATSUBA_THRESHOLD) {
+    mulSchoolbook(a, n, b, n, res);
+    return;
+  }
+  int k = n / 2, h = n - k;
+  uint32_t* sum_a = scratch;
+  uint32_t* sum_b = sum_a + h + 1;
+  uint32_t* mid = sum_b + h + 1;
+  std::copy(a + k, a + n, sum_a);
+  std::copy(b + k, b + n, sum_b);
+  sum_a[h] = addTo(sum_a, h, a, k);
+  sum_b[h] = addTo(sum_b, h, b, k);
+  if (n >= KARATSUBA_FORK_THRESHOLD) {
+    // The outer products get scratch of their own so that they can run beside the middle one.
+    std::future<void> low = ForkJoin::fork([=] {
+      LimbVector own(karatsubaScratch(k));
+      mulKaratsuba(a, b, k, res, own.data());
+    });
+    std::future<void> high = ForkJoin::fork([=] {
+      LimbVector own(karatsubaScratch(h));
+      mulKaratsuba(a + k, b + k, h, res + 2 * k, own.data());
+    });
+    mulKaratsuba(sum_a, sum_b, h + 1, mid, mid + 2 * h + 2);
+    low.get();
+    high.get();
+  } else {
+    // mid is free until the middle product, and its region covers the outer products' scratch.
+    mulKaratsuba(a, b, k, res, mid);
+    mulKaratsuba(a + k, b + k, h, res + 2 * k, mid);
+    mulKaratsuba(sum_a, sum_b, h + 1, mid, mid + 2 * h + 2);
+  }
+  subFrom(mid, 2 * h + 2, res, 2 * k);
+  subFrom(mid, 2 * h + 2, res + 2 * k, 2 * h);
+  int len = 2 * h + 2;
+  while (len > 0 && mid[len - 1] == 0) { --len; }
+  addTo(res + k, 2 * n - k, mid, len);
+}
+void BigInteger::multiply(const uint32_t* a, int n, const uint32_t* b, int m, uint32_t* res) {
+  if (n < m) {
+    std::swap(a, b);
+    std::swap(n, m);
+  }
+  if (m < KARATSUBA_THRESHOLD) {
+    mulSchoolbook(a, n, b, m, res);
+    return;
+  }
+  thread_local LimbVector scratch;
+  scratch.resize(3 * m + karatsubaScratch(m));
+  uint32_t* chunk = scratch.data();
+  uint32_t* prod = chunk + m;
+  std::fill(res, res + n + m, 0);
+  for (int i = 0; i < n; i += m) {
+    int len = std::min(m, n - i);
+    const uint32_t* part = a + i;
+    if (len < m) {
+      std::copy(part, part + len, chunk);
+      std::fill(chunk + len, chunk + m, 0);
+      part = chunk;
+    }
+    mulKaratsuba(part, b, m, prod, prod + 2 * m);
+    addTo(res + i, n + m - i, prod, std::min(2 * m, n + m - i));
+  }
+}
+void BigInteger::multiplyMagnitudes(const BigInteger& a, const BigInteger& b, LimbVector& res) {
+  int min_size = std::min(a.size(), b.size());
+  if (min_size >= NTT_THRESHOLD && a.size() + b.size() <= NTT_MAX_LENGTH) {
+    res = multiplyNtt(a.digits, b.digits);
+  } else if (min_size >= TOOM3_THRESHOLD) {
+    res = std::move(toomCook3(a.abs(), b.abs()).digits);
+  } else {
+    res.resize(a.size() + b.size());
+    multiply(a.digits.data(), a.size(), b.digits.data(), b.size(), res.data());
+  }
+  while (res.size() > 1 && res.back() == 0) { res.pop_back(); }
+}
+BigInteger BigInteger::toomCook3(const BigInteger& a, const BigInteger& b) {
+  if (a.size() < b.size()) { return toomCook3(b, a); }
+  if (a.size() >= 2 * b.size()) {
+    BigInteger res;
+    for (int i = 0; i < a.size(); i += b.size()) {
+      BigInteger part = a.slice(i, b.size()) * b;
+      part.shiftLimbs(i);
+      res += part;
+    }
+    return res;
+  }
+  int k = (a.size() + 2) / 3;
+  BigInteger a0 = a.slice(0, k), a1 = a.slice(k, k), a2 = a.slice(2 * k, k);
+  BigInteger b0 = b.slice(0, k), b1 = b.slice(k, k), b2 = b.slice(2 * k, k);
+  BigInteger a02 = a0 + a2, b02 = b0 + b2;
+  BigInteger w0, w1, wm1, wm2, winf;
+  std::future<void> tasks[] = {
+      ForkJoin::fork([&] { w1 = (a02 + a1) * (b02 + b1); }),
+      ForkJoin::fork([&] { wm1 = (a02 - a1) * (b02 - b1); }),
+      ForkJoin::fork([&] { wm2 = (a0 - 2 * a1 + 4 * a2) * (b0 - 2 * b1 + 4 * b2); }),
+      ForkJoin::fork([&] { winf = a2 * b2; }),
+  };
+  w0 = a0 * b0;
+  for (std::future<void>& task : tasks) { task.get(); }
+  BigInteger r3 = wm2 - w1;
+  r3.divideSmall(3);
+  BigInteger r1 = w1 - wm1;
+  r1.divideSmall(2);
+  BigInteger r2 = wm1 - w0;
+  r3 = r2 - r3;
+  r3.divideSmall(2);
+  r3 += 2 * winf;
+  r2 += r1;
+  r2 -= winf;
+  r1 -= r3;
+  BigInteger res = winf;
+  for (BigInteger* coefficient : {&r3, &r2, &r1, &w0}) {
+    res.shiftLimbs(k);
+    res += *coefficient;
+  }
+  return res;
+}
+long long BigInteger::powMod(long long x, long long p, long long mod) {
+  long long res = 1;
+  x %= mod;
+  while (p) {
+    if (p & 1) { res = res * x % mod; }
+    x = x * x % mod;
+    p >>= 1;
+  }
+  return res;
+}
+template <long long P>
+void BigInteger::ntt(std::vector<long long>& a, bool invert) {
+  int n = static_cast<int>(a.size());
+  for (int i = 1, j = 0; i < n; ++i) {
+    int bit = n >> 1;
+    for (; j & bit; bit >>= 1) { j ^= bit; }
+    j ^= bit;
+    if (i < j) { std::swap(a[i], a[j]); }
+  }
+  std::vector<long long> w(n / 2);
+  for (int len = 2; len <= n; len <<= 1) {
+    long long w_len = powMod(NTT_ROOT, (P - 1) / len, P);
+    if (invert) { w_len = powMod(w_len, P - 2, P); }
+    int half = len / 2;
+    w[0] = 1;
+    for (int j = 1; j < half; ++j) { w[j] = w[j - 1] * w_len % P; }
+    for (int i = 0; i < n; i += len) {
+      for (int j = 0; j < half; ++j) {
+        long long u = a[i + j], v = a[i + j + half] * w[j] % P;
+        a[i + j] = u + v < P ? u + v : u + v - P;
+        a[i + j + half] = u - v >= 0 ? u - v : u - v + P;
+      }
+    }
+  }
+  if (invert) {
+    long long n_inv = powMod(n, P - 2, P);
+    for (long long& x : a) { x = x * n_inv % P; }
+  }
+}
+template <long long P>
+void BigInteger::convolve(const LimbVector& a, const LimbVector& b, bool square,
+                          std::vector<long long>& res) {
+  int len = static_cast<int>(res.size());
+  for (int i = 0; i < static_cast<int>(a.size()); ++i) { res[i] = a[i] % P; }
+  ntt<P>(res, false);
+  if (square) {
+    for (long long& x : res) { x = x * x % P; }
+  } else {
+    std::vector<long long> fb(len);
+    for (int i = 0; i < static_cast<int>(b.size()); ++i) { fb[i] = b[i] % P; }
+    ntt<P>(fb, false);
+    for (int i = 0; i < len; ++i) { res[i] = res[i] * fb[i] % P; }
+  }
+  ntt<P>(res, true);
+}
+LimbVector BigInteger::multiplyNtt(const LimbVector& a, const LimbVector& b) {
+  bool square = a == b;
+  int n = static_cast<int>(a.size()), m = static_cast<int>(b.size());
+  int len = 1;
+  while (len < n + m) { len <<= 1; }
+  std::vector<long long> conv0(len), conv1(len), conv2(len);
+  std::future<void> task1 = ForkJoin::fork([&] { convolve<NTT_PRIME_1>(a, b, square, conv1); });
+  std::future<void> task2 = ForkJoin::fork([&] { convolve<NTT_PRIME_2>(a, b, square, conv2); });
+  convolve<NTT_PRIME_0>(a, b, square, conv0);
+  task1.get();
+  task2.get();
+  const long long p0 = NTT_PRIME_0, p1 = NTT_PRIME_1, p2 = NTT_PRIME_2;
+  long long inv_p0_mod_p1 = powMod(p0, p1 - 2, p1);
+  long long inv_p0p1_mod_p2 = powMod(p0 % p2 * p1 % p2, p2 - 2, p2);
+  LimbVector res(n + m);
+  uint64_t carry = 0;
+  for (int i = 0; i < n + m; ++i) {
+    long long x0 = conv0[i], x1 = conv1[i], x2 = conv2[i];
+    long long t1 = (x1 - x0 % p1 + p1) % p1 * inv_p0_mod_p1 % p1;
+    long long t2 = ((x2 - x0 % p2 - t1 * (p0 % p2) % p2) % p2 + 2 * p2) % p2 * inv_p0p1_mod_p2 % p2;
+    uint64_t high = t1 + t2 * p1;
+    uint64_t low = x0 + p0 * (high & (BASE - 1)) + carry;
+    res[i] = static_cast<uint32_t>(low);
+    carry = (low >> LIMB_BITS) + p0 * (high >> LIMB_BITS);
+  }
+  return res;
+}
+void BigInteger::divmodKnuth(const LimbVector& a, const LimbVector& b,
+                             LimbVector& quotient, LimbVector& remainder) {
+  int n = static_cast<int>(b.size()), m = static_cast<int>(a.size()) - n;
+  if (n == 1) {
+    uint32_t d = b[0];
+    quotient = a;
+    remainder.assign(1, divSmall(quotient.data(), m + 1, d));
+    return;
+  }
+  int shift = 0;
+  while (!(b.back() << shift >> (LIMB_BITS - 1))) { ++shift; }
+  thread_local LimbVector u, v;
+  u.resize(m + n + 1);
+  v.resize(n);
+  for (int i = n - 1; i >= 0; --i) {
+    v[i] = b[i] << shift | (shift && i ? b[i - 1] >> (LIMB_BITS - shift) : 0);
+  }
+  u[m + n] = shift ? a[m + n - 1] >> (LIMB_BITS - shift) : 0;
+  for (int i = m + n - 1; i >= 0; --i) {
+    u[i] = a[i] << shift | (shift && i ? a[i - 1] >> (LIMB_BITS - shift) : 0);
+  }
+  quotient.assign(m + 1, 0);
+  for (int j = m; j >= 0; --j) {
+    uint64_t top = static_cast<uint64_t>(u[j + n]) << LIMB_BITS | u[j + n - 1];
+    uint64_t q_hat = top / v[n - 1], r_hat = top % v[n - 1];
+    while (q_hat >= BASE || q_hat * v[n - 2] > (r_hat << LIMB_BITS | u[j + n - 2])) {
+      --q_hat;
+      r_hat += v[n - 1];
+      if (r_hat >= BASE) { break; }
+    }
+    uint64_t carry = 0;
+    uint32_t borrow = 0;
+    for (int i = 0; i < n; ++i) {
+      carry += q_hat * v[i];
+      uint64_t sub = (carry & (BASE - 1)) + borrow;
+      borrow = u[i + j] < sub;
+      u[i + j] = static_cast<uint32_t>(u[i + j] - sub);
+      carry >>= LIMB_BITS;
+    }
+    bool negative = u[j + n] < carry + borrow;
+    u[j + n] = static_cast<uint32_t>(u[j + n] - carry - borrow);
+    if (negative) {
+      --q_hat;
+      u[j + n] += addTo(u.data() + j, n, v.data(), n);
+    }
+    quotient[j] = static_cast<uint32_t>(q_hat);
+  }
+  remainder.resize(n);
+  for (int i = 0; i < n; ++i) {
+    remainder[i] = u[i] >> shift | (shift ? u[i + 1] << (LIMB_BITS - shift) : 0);
+  }
+}
+
+BigInteger BigInteger::reciprocal(const BigInteger& v) {
+  int k = v.size();
+  BigInteger res = 1;
+  if (k <= NEWTON_BASE) {
+    res.shiftLimbs(2 * k);
+    return divmod(res, v).first;
+  }
+  int h = (k + 1) / 2 + 2;
+  BigInteger y = reciprocal(v.slice(k - h, h));
+  res.shiftLimbs(k + h);
+  res -= v * y;
+  res *= y;
+  res.shiftLimbs(-2 * h);
+  y.shiftLimbs(k - h);
+  return res += y;
+}
+void BigInteger::correctDivision(BigInteger& q, BigInteger& r, const BigInteger& b) {
+  while (r.sign < 0) {
+    --q;
+    r += b;
+  }
+  while (!less(r.digits, b.digits)) {
+    ++q;
+    r -= b;
+  }
+}
+std::pair<BigInteger, BigInteger> BigInteger::divmodNewton(const BigInteger& a, const BigInteger& b) {
+  int n = b.size(), k = a.size() - n + 1;
+  if (k + 1 < n) {
+    BigInteger q = divmodNewton(a.slice(n - k - 1, a.size()), b.slice(n - k - 1, n)).first;
+    BigInteger r = a - q * b;
+    correctDivision(q, r, b);
+    return {q, r};
+  }
+  return divmodByReciprocal(a, b, reciprocal(b));
+}
+std::pair<BigInteger, BigInteger> BigInteger::divmodByReciprocal(const BigInteger& a, const BigInteger& b,
+                                                                 const BigInteger& inv) {
+  int n = b.size();
+  BigInteger q, r;
+  for (int i = (a.size() - 1) / n * n; i >= 0; i -= n) {
+    BigInteger cur = r;
+    cur.shiftLimbs(n);
+    cur += a.slice(i, n);
+    q.shiftLimbs(n);
+    if (less(cur.digits, b.digits)) {
+      r = cur;
+      continue;
+    }
+    BigInteger q_block = cur * inv;
+    q_block.shiftLimbs(-2 * n);
+    r = cur - q_block * b;
+    correctDivision(q_block, r, b);
+    q += q_block;
+  }
+  return {q, r};
+}
+const BigInteger& BigInteger::decimalPower(int level) {
+  static std::mutex lock;
+  static std::deque<BigInteger> powers = {BigInteger(DECIMAL_BASE)};
+  std::lock_guard<std::mutex> guard(lock);
+  while (static_cast<int>(powers.size()) <= level) { powers.push_back(powers.back() * powers.back()); }
+  return powers[level];
+}
+const BigInteger& BigInteger::decimalReciprocal(int level) {
+  static std::mutex lock;
+  static std::deque<BigInteger> reciprocals;
+  std::lock_guard<std::mutex> guard(lock);
+  while (static_cast<int>(reciprocals.size()) <= level) { reciprocals.emplace_back(); }
+  if (!reciprocals[level]) { reciprocals[level] = reciprocal(decimalPower(level)); }
+  return reciprocals[level];
+}
+int BigInteger::decimalLevel(int limbs) {
+  int level = 0;
+  while (decimalPower(level + 1).size() * 2 <= limbs) { ++level; }
+  return level;
+}
+BigInteger BigInteger::parseDecimal(const char* s, int len) {
+  if (len > CONVERSION_THRESHOLD * DECIMAL_DIGITS) {
+    int level = decimalLevel(len / DECIMAL_DIGITS);
+    int low_len = DECIMAL_DIGITS << level;
+    BigInteger res = parseDecimal(s, len - low_len);
+    res *= decimalPower(level);
+    return res += parseDecimal(s + len - low_len, low_len);
+  }
+  BigInteger res;
+  res.digits.reserve(len / DECIMAL_DIGITS + 1);
+  for (int i = 0, chunk = (len - 1) % DECIMAL_DIGITS + 1; i < len; i += chunk, chunk = DECIMAL_DIGITS) {
+    uint32_t value = 0, scale = 1;
+    for (int j = i; j < i + chunk; ++j) {
+      value = value * 10 + (s[j] - '0');
+      scale *= 10;
+    }
+    uint32_t carry = mulSmall(res.digits.data(), res.size(), scale);
+    if (carry) { res.digits.push_back(carry); }
+    carry = addTo(res.digits.data(), res.size(), &value, 1);
+    if (carry) { res.digits.push_back(carry); }
+  }
+  res.sign = 1;
+  res.removeLeadZeroes();
+  return res;
+}
+void BigInteger::appendDecimal(std::string& out, int width) const {
+  if (size() > CONVERSION_THRESHOLD) {
+    int level = decimalLevel(size());
+    int low_width = DECIMAL_DIGITS << level;
+    const BigInteger& power = decimalPower(level);
+    std::pair<BigInteger, BigInteger> parts = power.size() >= NEWTON_THRESHOLD
+        ? divmodByReciprocal(*this, power, decimalReciprocal(level))
+        : divmod(*this, power);
+    parts.first.appendDecimal(out, width ? width - low_width : 0);
+    parts.second.appendDecimal(out, low_width);
+    return;
+  }
+  uint32_t tmp[CONVERSION_THRESHOLD];
+  char buffer[CONVERSION_THRESHOLD * 10 + 1];
+  std::copy(digits.begin(), digits.end(), tmp);
+  int len = size(), pos = sizeof(buffer);
+  do {
+    uint32_t chunk = divSmall(tmp, len, DECIMAL_BASE);
+    while (len > 0 && tmp[len - 1] == 0) { --len; }
+    for (int i = 0; i < DECIMAL_DIGITS && (len > 0 || chunk > 0 || pos == sizeof(buffer)); ++i) {
+      buffer[--pos] = static_cast<char>('0' + chunk % 10);
+      chunk /= 10;
+    }
+  } while (len > 0);
+  int written = static_cast<int>(sizeof(buffer)) - pos;
+  if (width > written) { out.append(width - written, '0'); }
+  out.append(buffer + pos, written);
+}
+
+void BigInteger::divmodTo(const BigInteger& a, const BigInteger& b, BigInteger& quotient, BigInteger& remainder) {
+  int a_sign = a.sign, b_sign = b.sign;
+  if (less(a.digits, b.digits)) {
+    remainder = a;
+    quotient = 0;
+    return;
+  }
+  if (std::min(b.size(), a.size() - b.size() + 1) >= NEWTON_THRESHOLD) {
+    std::pair<BigInteger, BigInteger> res = divmodNewton(a.abs(), b.abs());
+    quotient = std::move(res.first);
+    remainder = std::move(res.second);
+  } else {
+    divmodKnuth(a.digits, b.digits, quotient.digits, remainder.digits);
+    quotient.sign = 1;
+    remainder.sign = 1;
+  }
+  quotient.sign *= a_sign * b_sign;
+  remainder.sign *= a_sign;
+  quotient.removeLeadZeroes();
+  remainder.removeLeadZeroes();
+}
+BigInteger& BigInteger::addSigned(const LimbVector& other, int other_sign) {
+  if (other_sign == 0) { return *this; }
+  if (&other == &digits) {
+    if (other_sign != sign) { return *this = 0; }
+    uint32_t carry = mulSmall(digits.data(), size(), 2);
+    if (carry) { digits.push_back(carry); }
+    return *this;
+  }
+  if (sign == 0) {
+    digits = other;
+    sign = other_sign;
+    return *this;
+  }
+  if (sign == other_sign) {
+    plus(digits, other);
+  } else if (!less(digits, other)) {
+    minus(digits, other);
+  } else {
+    digits.resize(other.size());
+    subReversed(digits.data(), other.data(), size());
+    sign = other_sign;
+  }
+  removeLeadZeroes();
+  return *this;
+}
+void BigInteger::addProduct(const BigInteger& b, const BigInteger& c, int product_sign) {
+  if (product_sign == 0) { return; }
+  thread_local LimbVector product;
+  multiplyMagnitudes(b, c, product);
+  addSigned(product, product_sign);
+}
+
+std::pair<BigInteger, BigInteger> divmod(const BigInteger& a, const BigInteger& b) {
+  std::pair<BigInteger, BigInteger> res;
+  BigInteger::divmodTo(a, b, res.first, res.second);
+  return res;
+}
+BigInteger BigInteger::fromWord(uint64_t x) {
+  BigInteger res = static_cast<long long>(x >> LIMB_BITS);
+  res.shiftLimbs(1);
+  return res += static_cast<long long>(x & (BASE - 1));
+}
+// Scales num / den so that the quotient has 63-64 bits, then rounds it to the precision
+// of a double (fewer bits in the subnormal range) with the division remainder as sticky bit.
+double BigInteger::ratioToDouble(const BigInteger& num, const BigInteger& den) {
+  if (num.sign == 0) { return 0.0; }
+  int num_bits = num.bitLength(), den_bits = den.bitLength();
+  if (num_bits <= 53 && den_bits <= 53) {
+    return num.sign * static_cast<double>(num.leadingBits(0)) / static_cast<double>(den.leadingBits(0));
+  }
+  int shift = den_bits - num_bits + 63;
+  BigInteger scaled = num.abs(), divisor = den, quotient, remainder;
+  if (shift > 0) {
+    scaled.shiftBits(shift);
+  } else {
+    divisor.shiftBits(-shift);
+  }
+  divmodTo(scaled, divisor, quotient, remainder);
+  uint64_t q = quotient.leadingBits(0);
+  int top = 63 - __builtin_clzll(q);
+  int precision = std::min(53, top - shift + 1075);
+  if (precision < 0) { return num.sign * 0.0; }
+  int drop = top + 1 - precision;
+  uint64_t mantissa = drop >= 64 ? 0 : q >> drop;
+  uint64_t rest = drop >= 64 ? q : q & ((1ull << drop) - 1), half = 1ull << (drop - 1);
+  if (rest > half || (rest == half && (remainder.sign != 0 || (mantissa & 1)))) { ++mantissa; }
+  return num.sign * std::ldexp(static_cast<double>(mantissa), drop - shift);
+}
+BigInteger BigInteger::fromLimbs(const uint32_t* limbs, int n) {
+  BigInteger res;
+  res.digits.assign(limbs, limbs + n);
+  res.sign = 1;
+  res.removeLeadZeroes();
+  return res;
+}
+uint64_t BigInteger::leadingBits(int shift) const {
+  int index = shift / LIMB_BITS, offset = shift % LIMB_BITS;
+  auto limb = [this](int i) -> uint64_t { return i < size() ? digits[i] : 0; };
+  uint64_t low = limb(index + 1) << LIMB_BITS | limb(index);
+  return offset ? low >> offset | limb(index + 2) << (2 * LIMB_BITS - offset) : low;
+}
+uint64_t BigInteger::binaryGcd(uint64_t a, uint64_t b) {
+  if (a == 0 || b == 0) { return a | b; }
+  int shift = __builtin_ctzll(a | b);
+  a >>= __builtin_ctzll(a);
+  while (b) {
+    b >>= __builtin_ctzll(b);
+    if (a > b) { std::swap(a, b); }
+    b -= a;
+  }
+  return a << shift;
+}
+void BigInteger::combineLimbs(LimbVector& a, LimbVector& b, int64_t u0, int64_t v0, int64_t u1, int64_t v1) {
+  int n = static_cast<int>(a.size());
+  b.resize(n);
+  int64_t carry_a = 0, carry_b = 0;
+  for (int i = 0; i < n; ++i) {
+    int64_t x = a[i], y = b[i];
+    carry_a += u0 * x + v0 * y;
+    carry_b += u1 * x + v1 * y;
+    a[i] = static_cast<uint32_t>(carry_a);
+    b[i] = static_cast<uint32_t>(carry_b);
+    carry_a >>= LIMB_BITS;
+    carry_b >>= LIMB_BITS;
+  }
+}
+// Knuth's Algorithm L: run Euclid on the leading 62 bits of a and b while the quotients
+// are provably the same as for the full numbers, then apply the accumulated cofactors
+// to all limbs at once. Stops once b fits in a machine word.
+void BigInteger::lehmerReduce(BigInteger& a, BigInteger& b, BigInteger* x0, BigInteger* x1) {
+  while (b.size() > 2) {
+    int shift = (a.size() - 1) * LIMB_BITS + (LIMB_BITS - __builtin_clz(a.digits.back())) - 62;
+    int64_t x = a.leadingBits(shift), y = b.leadingBits(shift);
+    int64_t u0 = 1, v0 = 0, u1 = 0, v1 = 1;
+    while (y + u1 > 0 && y + v1 > 0) {
+      int64_t q = (x + u0) / (y + u1);
+      if (q != (x + v0) / (y + v1)) { break; }
+      int64_t next_u = u0 - q * u1, next_v = v0 - q * v1;
+      if (std::max(std::llabs(next_u), std::llabs(next_v)) >= LEHMER_COFACTOR_LIMIT) { break; }
+      u0 = u1;
+      v0 = v1;
+      u1 = next_u;
+      v1 = next_v;
+      std::swap(x, y);
+      y -= q * x;
+    }
+    if (v0 == 0) {
+      std::pair<BigInteger, BigInteger> qr = divmod(a, b);
+      a = std::move(b);
+      b = std::move(qr.second);
+      if (x0) {
+        submul(*x0, qr.first, *x1);
+        std::swap(*x0, *x1);
+      }
+      continue;
+    }
+    combineLimbs(a.digits, b.digits, u0, v0, u1, v1);
+    a.removeLeadZeroes();
+    b.removeLeadZeroes();
+    if (x0) {
+      BigInteger next_x0 = *x0 * u0, next_x1 = *x0 * u1;
+      addmul(next_x0, *x1, v0);
+      addmul(next_x1, *x1, v1);
+      *x0 = std::move(next_x0);
+      *x1 = std::move(next_x1);
+    }
+  }
+}
+
+void addmul(BigInteger& a, const BigInteger& b, const BigInteger& c) { a.addProduct(b, c, b.sign * c.sign); }
+void submul(BigInteger& a, const BigInteger& b, const BigInteger& c) { a.addProduct(b, c, -b.sign * c.sign); }
+BigInteger gcd(BigInteger a, BigInteger b) {
+  a = a.abs();
+  b = b.abs();
+  if (less(a.digits, b.digits)) { std::swap(a, b); }
+  BigInteger::lehmerReduce(a, b, nullptr, nullptr);
+  if (b.sgn() == 0) { return a; }
+  a %= b;
+  return BigInteger::fromWord(BigInteger::binaryGcd(a.leadingBits(0), b.leadingBits(0)));
+}
+BigInteger lcm(const BigInteger& a, const BigInteger& b) {
+  if (a.sgn() == 0 || b.sgn() == 0) { return 0; }
+  return (a / gcd(a, b) * b).abs();
+}
+BigInteger extendedGcd(BigInteger a, BigInteger b, BigInteger& x, BigInteger& y) {
+  int a_sign = a.sgn(), b_sign = b.sgn();
+  a = a.abs();
+  b = b.abs();
+  bool swapped = less(a.digits, b.digits);
+  if (swapped) { std::swap(a, b); }
+  BigInteger original_a = a, original_b = b, x1 = 0;
+  x = 1;
+  BigInteger::lehmerReduce(a, b, &x, &x1);
+  while (b) {
+    std::pair<BigInteger, BigInteger> qr = divmod(a, b);
+    a = std::move(b);
+    b = std::move(qr.second);
+    submul(x, qr.first, x1);
+    std::swap(x, x1);
+  }
+  y = original_b ? (a - original_a * x) / original_b : 0;
+  if (swapped) { std::swap(x, y); }
+  if (a_sign < 0) { x.changeSign(); }
+  if (b_sign < 0) { y.changeSign(); }
+  return a;
+}
+
 std::ostream& operator<<(std::ostream& out, const BigInteger& BigInteger) {
   out << BigInteger.toString();
   return out;
 }
 std::istream& operator>>(std::istream& in, BigInteger& a) {
   std::string s;
-  in >> s;
-  a = s;
+  if (!(in >> s)) { return in; }
+  try {
+    a = s;
+  } catch (const std::invalid_argument&) {
+    in.setstate(std::ios::failbit);
+  }
   return in;
 }
 BigInteger operator "" _bi(const char* str, size_t) { return BigInteger(str); }
+// Binary format: a 32-bit little-endian header holding the limb count with the sign of
+// the number (0 for zero), followed by that many 32-bit little-endian limbs.
+std::ostream& writeBinary(std::ostream& out, const BigInteger& a) {
+  int32_t header = a.sign * a.size();
+  uint32_t raw = static_cast<uint32_t>(header);
+#ifdef BIGINTEGER_BIG_ENDIAN
+  raw = __builtin_bswap32(raw);
+  out.write(reinterpret_cast<const char*>(&raw), sizeof(raw));
+  for (int i = 0; header && i < a.size(); ++i) {
+    uint32_t limb = __builtin_bswap32(a.digits[i]);
+    out.write(reinterpret_cast<const char*>(&limb), sizeof(limb));
+  }
+#else
+  out.write(reinterpret_cast<const char*>(&raw), sizeof(raw));
+  if (header) { out.write(reinterpret_cast<const char*>(a.digits.data()), a.size() * sizeof(uint32_t)); }
+#endif
+  return out;
+}
+std::istream& readBinary(std::istream& in, BigInteger& a) {
+  uint32_t raw;
+  if (!in.read(reinterpret_cast<char*>(&raw), sizeof(raw))) { return in; }
+#ifdef BIGINTEGER_BIG_ENDIAN
+  raw = __builtin_bswap32(raw);
+#endif
+  int32_t header = static_cast<int32_t>(raw);
+  if (header == INT32_MIN) {
+    in.setstate(std::ios::failbit);
+    return in;
+  }
+  if (header == 0) {
+    a = 0;
+    return in;
+  }
+  // The limb count comes from the stream, so storage grows only as limbs actually arrive.
+  const size_t read_chunk = 1 << 16;
+  size_t n = header > 0 ? header : -header;
+  LimbVector limbs;
+  while (limbs.size() < n) {
+    size_t done = limbs.size();
+    limbs.resize(std::min(n, done + read_chunk));
+    if (!in.read(reinterpret_cast<char*>(limbs.data() + done), (limbs.size() - done) * sizeof(uint32_t))) {
+      a = 0;
+      return in;
+    }
+  }
+#ifdef BIGINTEGER_BIG_ENDIAN
+  for (uint32_t& limb : limbs) { limb = __builtin_bswap32(limb); }
+#endif
+  std::swap(a.digits, limbs);
+  a.sign = header > 0 ? 1 : -1;
+  a.removeLeadZeroes();
+  return in;
+}
+
+#ifdef BIGINTEGER_MMAP
+// Read-only view of a file of BigIntegers in the binary format above. The file is mapped
+// into memory and only the record offsets are built on open; limbs() points straight
+// into the mapping. Indexing stops at a corrupt header (INT32_MIN) or a record that runs
+// past the end of the file; isComplete() tells whether the whole file was indexed.
+class BigIntegerArrayView {
+ public:
+  explicit BigIntegerArrayView(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { return; }
+    struct stat info;
+    if (fstat(fd, &info) == 0) {
+      length = static_cast<size_t>(info.st_size);
+      void* mapping = length ? mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+      if (mapping != MAP_FAILED) {
+        words = static_cast<const uint32_t*>(mapping);
+        opened = true;
+      }
+    }
+    ::close(fd);
+    if (!opened) { return; }
+    size_t count = length / sizeof(uint32_t);
+    size_t pos = 0;
+    while (pos < count) {
+      int32_t header = static_cast<int32_t>(words[pos]);
+      if (header == INT32_MIN) { break; }
+      size_t n = magnitude(header);
+      if (pos + 1 + n > count) { break; }
+      offsets.push_back(pos);
+      pos += 1 + n;
+    }
+    complete = pos == count && length % sizeof(uint32_t) == 0;
+  }
+  BigIntegerArrayView(const BigIntegerArrayView&) = delete;
+  BigIntegerArrayView& operator=(const BigIntegerArrayView&) = delete;
+  ~BigIntegerArrayView() {
+    if (words) { munmap(const_cast<uint32_t*>(words), length); }
+  }
+  bool isOpen() const { return opened; }
+  bool isComplete() const { return complete; }
+  size_t size() const { return offsets.size(); }
+  int sign(size_t i) const {
+    int32_t header = static_cast<int32_t>(words[offsets[i]]);
+    return (header > 0) - (header < 0);
+  }
+  int limbCount(size_t i) const { return magnitude(static_cast<int32_t>(words[offsets[i]])); }
+  const uint32_t* limbs(size_t i) const { return words + offsets[i] + 1; }
+  BigInteger operator[](size_t i) const {
+    if (limbCount(i) == 0) { return 0; }
+    BigInteger res = BigInteger::fromLimbs(limbs(i), limbCount(i));
+    if (sign(i) < 0) { res.changeSign(); }
+    return res;
+  }
+ private:
+  const uint32_t* words = nullptr;
+  size_t length = 0;
+  bool opened = false;
+  bool complete = false;
+  std::vector<size_t> offsets;
+  // Only called on headers other than INT32_MIN, which open() treats as corruption.
+  static int magnitude(int32_t header) { return header < 0 ? -header : header; }
+};
+#endif
+
+// Collection of BigIntegers whose limbs live in one shared buffer, described by parallel
+// arrays of offsets, capacities, sizes and signs (zero has no limbs). Elements keep one
+// limb of slack so that element-wise updates usually stay in place; an element that
+// outgrows its slot moves to the end of the buffer, and the buffer is compacted once
+// more than half of it is abandoned slots. Element-wise operations and dot() treat the
+// elements a shorter operand lacks as zero; += and -= grow this vector to the length of
+// the longer one.
+class BigVector {
+ public:
+  BigVector() = default;
+  explicit BigVector(const std::vector<BigInteger>& values) {
+    for (const BigInteger& x : values) { push_back(x); }
+  }
+  size_t size() const { return sizes.size(); }
+  int sign(size_t i) const { return signs[i]; }
+  int limbCount(size_t i) const { return sizes[i]; }
+  const uint32_t* limbs(size_t i) const { return buffer.data() + offsets[i]; }
+  void push_back(const BigInteger& x) { pushLimbs(x.digits.data(), x.sgn() ? x.size() : 0, x.sgn()); }
+  BigInteger operator[](size_t i) const {
+    if (sizes[i] == 0) { return 0; }
+    BigInteger res = BigInteger::fromLimbs(limbs(i), sizes[i]);
+    if (signs[i] < 0) { res.changeSign(); }
+    return res;
+  }
+  void set(size_t i, const BigInteger& x) {
+    int n = x.sgn() ? x.size() : 0;
+    reserveElement(i, n);
+    std::copy(x.digits.begin(), x.digits.begin() + n, buffer.begin() + offsets[i]);
+    sizes[i] = n;
+    signs[i] = x.sgn();
+  }
+  BigVector& operator+=(const BigVector& other) {
+    size_t common = std::min(size(), other.size());
+    for (size_t i = 0; i < common; ++i) { addElement(i, other, i, other.signs[i]); }
+    for (size_t i = common; i < other.size(); ++i) { pushLimbs(other.limbs(i), other.sizes[i], other.signs[i]); }
+    return *this;
+  }
+  BigVector& operator-=(const BigVector& other) {
+    size_t common = std::min(size(), other.size());
+    for (size_t i = 0; i < common; ++i) { addElement(i, other, i, -other.signs[i]); }
+    for (size_t i = common; i < other.size(); ++i) { pushLimbs(other.limbs(i), other.sizes[i], -other.signs[i]); }
+    return *this;
+  }
+  // Sum of all elements; positive and negative terms go into two wide accumulators.
+  BigInteger sum() const {
+    int width = 1;
+    for (int n : sizes) { width = std::max(width, n); }
+    width += carryLimbs(size());
+    LimbVector positive(width), negative(width);
+    for (size_t i = 0; i < size(); ++i) {
+      LimbVector& acc = signs[i] > 0 ? positive : negative;
+      BigInteger::addTo(acc.data(), width, limbs(i), sizes[i]);
+    }
+    return difference(positive, negative);
+  }
+  // Sum of element-wise products with another vector of the same length.
+  BigInteger dot(const BigVector& other) const {
+    size_t count = std::min(size(), other.size());
+    int width = 1, widest = 0;
+    for (size_t i = 0; i < count; ++i) {
+      width = std::max(width, sizes[i] + other.sizes[i]);
+      widest = std::max(widest, std::max(sizes[i], other.sizes[i]));
+    }
+    width += carryLimbs(count);
+    LimbVector positive(width), negative(width), prod(2 * widest);
+    for (size_t i = 0; i < count; ++i) {
+      int product_sign = signs[i] * other.signs[i];
+      if (product_sign == 0) { continue; }
+      int n = sizes[i] + other.sizes[i];
+      BigInteger::multiply(limbs(i), sizes[i], other.limbs(i), other.sizes[i], prod.data());
+      BigInteger::addTo((product_sign > 0 ? positive : negative).data(), width, prod.data(), n);
+    }
+    return difference(positive, negative);
+  }
+ private:
+  std::vector<uint32_t> buffer;
+  std::vector<size_t> offsets;
+  std::vector<int> capacities;
+  std::vector<int> sizes;
+  std::vector<int> signs;
+  size_t abandoned = 0;
+  void pushLimbs(const uint32_t* limbs, int n, int sign) {
+    offsets.push_back(buffer.size());
+    capacities.push_back(n + 1);
+    sizes.push_back(n);
+    signs.push_back(sign);
+    buffer.insert(buffer.end(), limbs, limbs + n);
+    buffer.push_back(0);
+  }
+  static int carryLimbs(size_t count) {
+    int limbs = 1;
+    for (; count >> (BigInteger::LIMB_BITS * limbs); ++limbs) {}
+    return limbs;
+  }
+  static BigInteger difference(const LimbVector& positive, const LimbVector& negative) {
+    return BigInteger::fromLimbs(positive.data(), static_cast<int>(positive.size())) -
+           BigInteger::fromLimbs(negative.data(), static_cast<int>(negative.size()));
+  }
+  void reserveElement(size_t i, int n) {
+    if (n <= capacities[i]) { return; }
+    size_t offset = buffer.size();
+    buffer.resize(offset + 2 * n);
+    std::copy(buffer.begin() + offsets[i], buffer.begin() + offsets[i] + sizes[i], buffer.begin() + offset);
+    abandoned += capacities[i];
+    offsets[i] = offset;
+    capacities[i] = 2 * n;
+    if (2 * abandoned > buffer.size()) { compact(); }
+  }
+  void compact() {
+    std::vector<uint32_t> packed;
+    packed.reserve(buffer.size() - abandoned);
+    for (size_t i = 0; i < size(); ++i) {
+      size_t offset = packed.size();
+      packed.insert(packed.end(), buffer.begin() + offsets[i], buffer.begin() + offsets[i] + capacities[i]);
+      offsets[i] = offset;
+    }
+    buffer.swap(packed);
+    abandoned = 0;
+  }
+  void addElement(size_t i, const BigVector& other, size_t j, int other_sign) {
+    int m = other.sizes[j];
+    if (other_sign == 0) { return; }
+    int n = std::max(sizes[i], m);
+    reserveElement(i, n + 1);
+    uint32_t* a = buffer.data() + offsets[i];
+    const uint32_t* b = other.limbs(j);
+    std::fill(a + sizes[i], a + n + 1, 0);
+    if (signs[i] == 0) {
+      std::copy(b, b + m, a);
+      signs[i] = other_sign;
+    } else if (signs[i] == other_sign) {
+      a[n] = BigInteger::addTo(a, n, b, m);
+      ++n;
+    } else if (sizes[i] > m || (sizes[i] == m && BigInteger::compareLimbs(a, b, m) >= 0)) {
+      BigInteger::subFrom(a, n, b, m);
+    } else {
+      BigInteger::subReversed(a, b, n);
+      signs[i] = other_sign;
+    }
+    while (n > 0 && a[n - 1] == 0) { --n; }
+    sizes[i] = n;
+    if (n == 0) { signs[i] = 0; }
+  }
+};
 bool operator<(const BigInteger& a, const BigInteger& b) {
   if (a.sgn() < b.sgn()) { return true; }
   if (a.sgn() > b.sgn()) { return false; }
@@ -215,69 +1574,426 @@ BigInteger operator+(const BigInteger& a, const BigInteger& b) {
   res += b;
   return res;
 }
+BigInteger operator+(BigInteger&& a, const BigInteger& b) { return std::move(a += b); }
+BigInteger operator+(const BigInteger& a, BigInteger&& b) { return std::move(b += a); }
+BigInteger operator+(BigInteger&& a, BigInteger&& b) { return std::move(a += b); }
 BigInteger operator-(const BigInteger& a, const BigInteger& b) {
   BigInteger res = a;
   res -= b;
   return res;
 }
+BigInteger operator-(BigInteger&& a, const BigInteger& b) { return std::move(a -= b); }
+BigInteger operator-(const BigInteger& a, BigInteger&& b) {
+  b -= a;
+  b.changeSign();
+  return std::move(b);
+}
+BigInteger operator-(BigInteger&& a, BigInteger&& b) { return std::move(a -= b); }
 BigInteger operator*(const BigInteger& a, const BigInteger& b) {
   BigInteger res = a;
   res *= b;
   return res;
 }
+BigInteger operator*(BigInteger&& a, const BigInteger& b) { return std::move(a *= b); }
+BigInteger operator*(const BigInteger& a, BigInteger&& b) { return std::move(b *= a); }
+BigInteger operator*(BigInteger&& a, BigInteger&& b) { return std::move(a *= b); }
 BigInteger operator/(const BigInteger& a, const BigInteger& b) {
   BigInteger res = a;
   res /= b;
   return res;
 }
+BigInteger operator/(BigInteger&& a, const BigInteger& b) { return std::move(a /= b); }
 BigInteger operator%(const BigInteger& a, const BigInteger& b) {
   BigInteger res = a;
   res %= b;
   return res;
 }
-void plus(std::vector<long long>& a, const std::vector<long long>& b, long long MOD) {
-  long long carry = 0;
-  for (int i = 0; (i < static_cast<int>(a.size()) || i < static_cast<int>(b.size()) || carry)
-    && (i < static_cast<int>(b.size()) || carry); ++i) {
-    if (i == static_cast<int>(a.size())) { a.push_back(0); }
-    a[i] += (i < static_cast<int>(b.size()) ? b[i] : 0) + carry;
-    carry = a[i] / MOD;
-    a[i] %= MOD;
+BigInteger operator%(BigInteger&& a, const BigInteger& b) { return std::move(a %= b); }
+BigInteger operator<<(const BigInteger& a, int k) {
+  BigInteger res = a;
+  res <<= k;
+  return res;
+}
+BigInteger operator<<(BigInteger&& a, int k) { return std::move(a <<= k); }
+BigInteger operator>>(const BigInteger& a, int k) {
+  BigInteger res = a;
+  res >>= k;
+  return res;
+}
+BigInteger operator>>(BigInteger&& a, int k) { return std::move(a >>= k); }
+void plus(LimbVector& a, const LimbVector& b) {
+  if (a.size() < b.size()) { a.resize(b.size()); }
+  uint32_t carry = BigInteger::addTo(a.data(), static_cast<int>(a.size()), b.data(), static_cast<int>(b.size()));
+  if (carry) { a.push_back(carry); }
+}
+void minus(LimbVector& a, const LimbVector& b) {
+  BigInteger::subFrom(a.data(), static_cast<int>(a.size()), b.data(), static_cast<int>(b.size()));
+}
+bool less(const LimbVector& a, const LimbVector& b) {
+  if (a.size() != b.size()) { return a.size() < b.size(); }
+  return BigInteger::compareLimbs(a.data(), b.data(), static_cast<int>(a.size())) < 0;
+}
+
+// Precomputed constants for arithmetic modulo a fixed odd modulus m. Values in Montgomery
+// form are x * R mod m with R = 2^(32 * limbs of m); multiplying two of them costs a
+// product and an O(n^2) reduction, with no division. Even (and zero) moduli have no
+// Montgomery form and are rejected with std::invalid_argument.
+class MontgomeryContext {
+ private:
+  static const int WINDOW_BITS = 4;
+  BigInteger mod;
+  BigInteger r_squared;
+  uint32_t mod_inverse;
+  int n;
+  void reduce(uint32_t* t, uint32_t* res) const {
+    const uint32_t* m = mod.digits.data();
+    t[2 * n] = 0;
+    for (int i = 0; i < n; ++i) {
+      uint32_t q = t[i] * mod_inverse;
+      uint32_t carry = BigInteger::addMulSmall(t + i, m, n, q);
+      for (int j = i + n; carry; ++j) {
+        uint64_t sum = static_cast<uint64_t>(t[j]) + carry;
+        t[j] = static_cast<uint32_t>(sum);
+        carry = static_cast<uint32_t>(sum >> BigInteger::LIMB_BITS);
+      }
+    }
+    if (t[2 * n] || BigInteger::compareLimbs(t + n, m, n) >= 0) { BigInteger::subFrom(t + n, n + 1, m, n); }
+    std::copy(t + n, t + 2 * n, res);
+  }
+  void multiplyLimbs(const uint32_t* a, const uint32_t* b, uint32_t* res, uint32_t* scratch) const {
+    BigInteger::multiply(a, n, b, n, scratch);
+    reduce(scratch, res);
+  }
+  // x itself when already in [0, m), otherwise x mod m stored in storage.
+  const BigInteger& reduced(const BigInteger& x, BigInteger& storage) const {
+    if (x.sgn() >= 0 && x < mod) { return x; }
+    storage = x % mod;
+    if (storage.sgn() < 0) { storage += mod; }
+    return storage;
+  }
+  void toLimbs(const BigInteger& x, uint32_t* res) const {
+    std::fill(res, res + n, 0);
+    std::copy(x.digits.begin(), x.digits.begin() + std::min(x.size(), n), res);
+  }
+ public:
+  explicit MontgomeryContext(const BigInteger& modulus): mod(modulus.abs()), n(mod.size()) {
+    if (!(mod.digits[0] & 1)) { throw std::invalid_argument("MontgomeryContext: modulus must be odd"); }
+    uint32_t inverse = 1;
+    for (int i = 0; i < 5; ++i) { inverse *= 2 - mod.digits[0] * inverse; }
+    mod_inverse = 0 - inverse;
+    r_squared = 1;
+    r_squared.shiftLimbs(2 * n);
+    r_squared %= mod;
+  }
+  const BigInteger& modulus() const { return mod; }
+  BigInteger toMontgomery(const BigInteger& x) const { return multiply(x, r_squared); }
+  BigInteger fromMontgomery(const BigInteger& x) const { return multiply(x, 1); }
+  // Montgomery product a * b / R mod m; operands outside [0, m) are reduced first.
+  BigInteger multiply(const BigInteger& a, const BigInteger& b) const {
+    BigInteger storage_a, storage_b;
+    LimbVector buffer(4 * n + 1);
+    toLimbs(reduced(a, storage_a), buffer.data());
+    toLimbs(reduced(b, storage_b), buffer.data() + n);
+    multiplyLimbs(buffer.data(), buffer.data() + n, buffer.data(), buffer.data() + 2 * n);
+    return BigInteger::fromLimbs(buffer.data(), n);
+  }
+  // base^exponent mod m for a non-negative exponent, with a fixed 4-bit window.
+  BigInteger pow(const BigInteger& base, const BigInteger& exponent) const {
+    if (exponent.sgn() < 0) { throw std::domain_error("MontgomeryContext::pow: negative exponent"); }
+    const int table_size = 1 << WINDOW_BITS;
+    LimbVector table(table_size * n), acc(n), scratch(2 * n + 1);
+    toLimbs(toMontgomery(1), table.data());
+    toLimbs(toMontgomery(base), table.data() + n);
+    for (int i = 2; i < table_size; ++i) {
+      multiplyLimbs(table.data() + (i - 1) * n, table.data() + n, table.data() + i * n, scratch.data());
+    }
+    std::copy(table.data(), table.data() + n, acc.data());
+    for (int bit = (exponent.bitLength() + WINDOW_BITS - 1) / WINDOW_BITS * WINDOW_BITS - WINDOW_BITS;
+         bit >= 0; bit -= WINDOW_BITS) {
+      for (int i = 0; i < WINDOW_BITS; ++i) { multiplyLimbs(acc.data(), acc.data(), acc.data(), scratch.data()); }
+      uint32_t window = exponent.digits[bit / BigInteger::LIMB_BITS] >> (bit % BigInteger::LIMB_BITS) & (table_size - 1);
+      if (window) { multiplyLimbs(acc.data(), table.data() + window * n, acc.data(), scratch.data()); }
+    }
+    return fromMontgomery(BigInteger::fromLimbs(acc.data(), n));
   }
+};
+
+BigInteger pow(BigInteger base, unsigned long long exponent) {
+  BigInteger res = 1;
+  for (; exponent; exponent >>= 1) {
+    if (exponent & 1) { res *= base; }
+    if (exponent > 1) { base *= base; }
+  }
+  return res;
+}
+// base^exponent mod |modulus|; throws std::domain_error for a zero modulus or a negative exponent.
+BigInteger powmod(const BigInteger& base, const BigInteger& exponent, const BigInteger& modulus) {
+  BigInteger mod = modulus.abs();
+  if (mod.sgn() == 0) { throw std::domain_error("powmod: zero modulus"); }
+  if (exponent.sgn() < 0) { throw std::domain_error("powmod: negative exponent"); }
+  if (mod == 1) { return 0; }
+  if (mod.digits[0] & 1) { return MontgomeryContext(mod).pow(base, exponent); }
+  BigInteger res = 1, power = base % mod;
+  if (power.sgn() < 0) { power += mod; }
+  for (int bit = 0; bit < exponent.bitLength(); ++bit) {
+    if (exponent.digits[bit / BigInteger::LIMB_BITS] >> (bit % BigInteger::LIMB_BITS) & 1) {
+      res *= power;
+      res %= mod;
+    }
+    power *= power;
+    power %= mod;
+  }
+  return res;
 }
-void minus(std::vector<long long>& a, const std::vector<long long>& b, long long MOD) {
-  long long carry = 0;
-  for (int i = 0; i < static_cast<int>(a.size()) && (i < static_cast<int>(b.size()) || carry); ++i) {
-    a[i] -= (i < static_cast<int>(b.size()) ? b[i] : 0) + carry;
-    carry = a[i] < 0;
-    if (carry) { a[i] += MOD; }
+// Floor of the k-th root (truncated towards zero for negative n and odd k). Newton's
+// iteration x = ((k - 1) x + n / x^(k - 1)) / k decreases monotonically to the root when
+// started above it. The start is one more than the root of the leading half of n (or of
+// its leading 53 bits, in doubles), so only the last couple of steps run at full size.
+// Throws std::domain_error for k < 1 and for negative n with even k.
+BigInteger iroot(const BigInteger& n, int k) {
+  if (k < 1) { throw std::domain_error("iroot: k must be positive"); }
+  if (n.sgn() < 0) {
+    if (k % 2 == 0) { throw std::domain_error("iroot: even root of a negative number"); }
+    return -iroot(-n, k);
+  }
+  if (n.sgn() == 0 || k == 1) { return n; }
+  if (k >= n.bitLength()) { return 1; }
+  BigInteger x;
+  int shift = n.bitLength() / 2 / k * k;
+  if (n.bitLength() > 2 * 53 && shift > 0) {
+    x = iroot(n >> shift, k) + 1;
+    x <<= shift / k;
+  } else {
+    shift = (std::max(0, n.bitLength() - 53) + k - 1) / k * k;
+    double top = static_cast<double>((n >> shift).leadingBits(0));
+    x = static_cast<long long>(std::pow(top, 1.0 / k)) + 2;
+    x <<= shift / k;
+  }
+  while (true) {
+    BigInteger y = x * (k - 1);
+    y += n / pow(x, k - 1);
+    y.divideSmall(k);
+    if (!(y < x)) { return x; }
+    x = std::move(y);
   }
 }
-bool less(const std::vector<long long>& a, const std::vector<long long>& b) {
-  if (a.size() < b.size()) { return true; }
-  if (a.size() > b.size()) { return false; }
-  for (int i = static_cast<int>(a.size()) - 1; i >= 0; --i) {
-    if (a[i] < b[i]) { return true; }
-    if (a[i] > b[i]) { return false; }
+BigInteger isqrt(const BigInteger& n) { return iroot(n, 2); }
+
+// Product over a balanced tree, so that every multiplication has operands of similar size;
+// the two halves of large ranges are multiplied on different threads.
+template <class Iterator>
+BigInteger product(Iterator first, Iterator last) {
+  const std::ptrdiff_t parallel_grain = 64;
+  std::ptrdiff_t count = std::distance(first, last);
+  if (count == 0) { return 1; }
+  if (count == 1) { return *first; }
+  Iterator middle = std::next(first, count / 2);
+  BigInteger left;
+  std::future<void> task;
+  if (count >= 2 * parallel_grain) {
+    task = ForkJoin::fork([&] { left = product(first, middle); });
+  } else {
+    left = product(first, middle);
   }
-  return false;
+  BigInteger right = product(middle, last);
+  if (task.valid()) { task.get(); }
+  return std::move(left *= right);
 }
+BigInteger product(const std::vector<BigInteger>& values) { return product(values.begin(), values.end()); }
+// Product of the integers in [from, to].
+BigInteger productRange(long long from, long long to) {
+  const long long parallel_grain = 1024;
+  if (from > to) { return 1; }
+  if (to - from < 16) {
+    BigInteger res = from;
+    for (long long i = from + 1; i <= to; ++i) { res *= i; }
+    return res;
+  }
+  long long middle = from + (to - from) / 2;
+  BigInteger left;
+  std::future<void> task;
+  if (to - from >= parallel_grain) {
+    task = ForkJoin::fork([&] { left = productRange(from, middle); });
+  } else {
+    left = productRange(from, middle);
+  }
+  BigInteger right = productRange(middle + 1, to);
+  if (task.valid()) { task.get(); }
+  return std::move(left *= right);
+}
+BigInteger factorial(long long n) { return productRange(2, n); }
+BigInteger binomial(long long n, long long k) {
+  if (k < 0 || k > n) { return 0; }
+  k = std::min(k, n - k);
+  return productRange(n - k + 1, n) / factorial(k);
+}
+
+// Lazily evaluated sums, differences and products of BigIntegers. Wrapping an operand in
+// lazy() turns the whole expression into a tree of nodes; evaluating it adds every product
+// straight into the result with addmul/submul, and the values that nested products still
+// need come from a thread-local stack of scratch BigIntegers that keep their capacity, so
+// after warm-up an expression costs no allocations. Nodes refer to their operands and must
+// not outlive the full expression that builds them.
+class BigScratch {
+ public:
+  BigScratch() = default;
+  BigScratch(const BigScratch&) = delete;
+  BigScratch& operator=(const BigScratch&) = delete;
+  ~BigScratch() {
+    if (slot) { --depth(); }
+  }
+  BigInteger& get() {
+    if (!slot) {
+      thread_local std::deque<BigInteger> slots;
+      if (depth() == slots.size()) { slots.emplace_back(); }
+      slot = &slots[depth()++];
+      *slot = 0;
+    }
+    return *slot;
+  }
+ private:
+  BigInteger* slot = nullptr;
+  static size_t& depth() {
+    thread_local size_t used = 0;
+    return used;
+  }
+};
+
+template <class E>
+class BigExpression {
+ public:
+  const E& self() const { return static_cast<const E&>(*this); }
+  const BigInteger& valueIn(BigScratch& scratch) const {
+    BigInteger& res = scratch.get();
+    self().addTo(res, 1);
+    return res;
+  }
+  operator BigInteger() const {
+    BigScratch scratch;
+    return self().valueIn(scratch);
+  }
+};
+
+class BigTerm : public BigExpression<BigTerm> {
+ public:
+  explicit BigTerm(const BigInteger& value): value(value) {}
+  void addTo(BigInteger& out, int sign) const {
+    if (sign > 0) {
+      out += value;
+    } else {
+      out -= value;
+    }
+  }
+  const BigInteger& valueIn(BigScratch&) const { return value; }
+ private:
+  const BigInteger& value;
+};
+
+class BigConstant : public BigExpression<BigConstant> {
+ public:
+  explicit BigConstant(long long value): value(value) {}
+  void addTo(BigInteger& out, int sign) const {
+    if (sign > 0) {
+      out += value;
+    } else {
+      out -= value;
+    }
+  }
+  const BigInteger& valueIn(BigScratch&) const { return value; }
+ private:
+  BigInteger value;
+};
+
+template <class L, class R>
+class BigSum : public BigExpression<BigSum<L, R>> {
+ public:
+  BigSum(const L& left, const R& right, int right_sign): left(left), right(right), right_sign(right_sign) {}
+  void addTo(BigInteger& out, int sign) const {
+    left.addTo(out, sign);
+    right.addTo(out, sign * right_sign);
+  }
+ private:
+  L left;
+  R right;
+  int right_sign;
+};
+
+template <class L, class R>
+class BigProduct : public BigExpression<BigProduct<L, R>> {
+ public:
+  BigProduct(const L& left, const R& right): left(left), right(right) {}
+  void addTo(BigInteger& out, int sign) const {
+    BigScratch left_scratch, right_scratch;
+    const BigInteger& a = left.valueIn(left_scratch);
+    const BigInteger& b = right.valueIn(right_scratch);
+    if (sign > 0) {
+      addmul(out, a, b);
+    } else {
+      submul(out, a, b);
+    }
+  }
+ private:
+  L left;
+  R right;
+};
+
+BigTerm lazy(const BigInteger& x) { return BigTerm(x); }
+template <class E>
+void evaluate(BigInteger& out, const BigExpression<E>& expr) {
+  BigScratch scratch;
+  const BigInteger& value = expr.self().valueIn(scratch);
+  if (&value != &out) { out = value; }
+}
+template <class E>
+BigInteger& operator+=(BigInteger& out, const BigExpression<E>& expr) {
+  BigScratch scratch;
+  return out += expr.self().valueIn(scratch);
+}
+template <class E>
+BigInteger& operator-=(BigInteger& out, const BigExpression<E>& expr) {
+  BigScratch scratch;
+  return out -= expr.self().valueIn(scratch);
+}
+template <class L, class R>
+BigSum<L, R> operator+(const BigExpression<L>& a, const BigExpression<R>& b) { return {a.self(), b.self(), 1}; }
+template <class L>
+BigSum<L, BigTerm> operator+(const BigExpression<L>& a, const BigInteger& b) { return {a.self(), BigTerm(b), 1}; }
+template <class R>
+BigSum<BigTerm, R> operator+(const BigInteger& a, const BigExpression<R>& b) { return {BigTerm(a), b.self(), 1}; }
+template <class L>
+BigSum<L, BigConstant> operator+(const BigExpression<L>& a, long long b) { return {a.self(), BigConstant(b), 1}; }
+template <class R>
+BigSum<BigConstant, R> operator+(long long a, const BigExpression<R>& b) { return {BigConstant(a), b.self(), 1}; }
+template <class L, class R>
+BigSum<L, R> operator-(const BigExpression<L>& a, const BigExpression<R>& b) { return {a.self(), b.self(), -1}; }
+template <class L>
+BigSum<L, BigTerm> operator-(const BigExpression<L>& a, const BigInteger& b) { return {a.self(), BigTerm(b), -1}; }
+template <class R>
+BigSum<BigTerm, R> operator-(const BigInteger& a, const BigExpression<R>& b) { return {BigTerm(a), b.self(), -1}; }
+template <class L>
+BigSum<L, BigConstant> operator-(const BigExpression<L>& a, long long b) { return {a.self(), BigConstant(b), -1}; }
+template <class R>
+BigSum<BigConstant, R> operator-(long long a, const BigExpression<R>& b) { return {BigConstant(a), b.self(), -1}; }
+template <class L, class R>
+BigProduct<L, R> operator*(const BigExpression<L>& a, const BigExpression<R>& b) { return {a.self(), b.self()}; }
+template <class L>
+BigProduct<L, BigTerm> operator*(const BigExpression<L>& a, const BigInteger& b) { return {a.self(), BigTerm(b)}; }
+template <class R>
+BigProduct<BigTerm, R> operator*(const BigInteger& a, const BigExpression<R>& b) { return {BigTerm(a), b.self()}; }
+template <class L>
+BigProduct<L, BigConstant> operator*(const BigExpression<L>& a, long long b) { return {a.self(), BigConstant(b)}; }
+template <class R>
+BigProduct<BigConstant, R> operator*(long long a, const BigExpression<R>& b) { return {BigConstant(a), b.self()}; }
 
 class Rational {
+  friend class RationalAccumulator;
+  friend std::ostream& writeBinary(std::ostream&, const Rational&);
+  friend std::istream& readBinary(std::istream&, Rational&);
   friend bool operator<(const Rational&, const Rational&);
   friend bool operator==(const Rational&, const Rational&);
  private:
   BigInteger num;
   BigInteger enom;
-  BigInteger gcd(BigInteger a, BigInteger b) {
-    if (a.sgn() < 0) { a.changeSign(); }
-    if (b.sgn() < 0) { b.changeSign(); }
-    while (b) {
-      a %= b;
-      std::swap(a, b);
-    }
-    return a;
-  }
   void normalize() {
     BigInteger g = gcd(num, enom);
     if (g != 1) {
@@ -351,7 +2067,7 @@ class Rational {
     if (num.sgn() < 0) { ans = '-' + ans; }
     return ans;
   }
-  explicit operator double() const { return std::stod(asDecimal(5)); }
+  explicit operator double() const { return BigInteger::ratioToDouble(num, enom); }
 };
 
 Rational operator+(const Rational& a, const Rational& b) {
@@ -370,9 +2086,94 @@ Rational operator/(const Rational& a, const Rational& b) {
   Rational res = a;
   return res /= b;
 }
-bool operator<(const Rational& a, const Rational& b) { return a.num * b.enom < b.num * a.enom; }
-bool operator==(const Rational& a, const Rational& b) { return a.num * b.enom == b.num * a.enom; }
+bool operator<(const Rational& a, const Rational& b) {
+  int sign = a.num.sgn();
+  if (sign != b.num.sgn()) { return sign < b.num.sgn(); }
+  if (a.enom == b.enom) { return a.num < b.num; }
+  int size_a = a.num.size() + b.enom.size(), size_b = b.num.size() + a.enom.size();
+  if (size_a + 1 < size_b) { return sign > 0; }
+  if (size_b + 1 < size_a) { return sign < 0; }
+  return a.num * b.enom < b.num * a.enom;
+}
+bool operator==(const Rational& a, const Rational& b) { return a.num == b.num && a.enom == b.enom; }
 bool operator!=(const Rational& a, const Rational& b) { return !(a == b); }
 bool operator>(const Rational& a, const Rational& b) { return (b < a); }
 bool operator<=(const Rational& a, const Rational& b) { return !(b < a); }
 bool operator>=(const Rational& a, const Rational& b) { return !(a < b); }
+// A Rational is stored as its numerator followed by its denominator.
+std::ostream& writeBinary(std::ostream& out, const Rational& r) { return writeBinary(writeBinary(out, r.num), r.enom); }
+std::istream& readBinary(std::istream& in, Rational& r) {
+  Rational res;
+  if (readBinary(readBinary(in, res.num), res.enom) && res.enom.sgn() > 0) {
+    res.normalize();
+    r = res;
+  } else {
+    in.setstate(std::ios::failbit);
+  }
+  return in;
+}
+void toDouble(const Rational* first, const Rational* last, double* out) {
+  for (; first != last; ++first, ++out) { *out = static_cast<double>(*first); }
+}
+std::vector<double> toDouble(const std::vector<Rational>& values) {
+  std::vector<double> res(values.size());
+  toDouble(values.data(), values.data() + values.size(), res.data());
+  return res;
+}
+
+// Sums rationals over the least common denominator seen so far and only cancels
+// common factors of the numerator once the denominator has doubled in size.
+class RationalAccumulator {
+ private:
+  static const int REDUCTION_THRESHOLD = 64;
+  BigInteger num;
+  BigInteger enom;
+  int reduction_size;
+  void add(const BigInteger& other_num, const BigInteger& other_enom, int other_sign) {
+    if (other_enom == enom) {
+      if (other_sign > 0) {
+        num += other_num;
+      } else {
+        num -= other_num;
+      }
+      return;
+    }
+    BigInteger g = gcd(enom, other_enom);
+    BigInteger scale = other_enom / g;
+    num *= scale;
+    if (other_sign > 0) {
+      addmul(num, other_num, enom / g);
+    } else {
+      submul(num, other_num, enom / g);
+    }
+    enom *= scale;
+    if (enom.size() >= reduction_size) { reduce(); }
+  }
+  void reduce() {
+    BigInteger g = gcd(num, enom);
+    if (g != 1) {
+      num /= g;
+      enom /= g;
+    }
+    reduction_size = (2 * enom.size() > REDUCTION_THRESHOLD ? 2 * enom.size() : REDUCTION_THRESHOLD);
+  }
+ public:
+  RationalAccumulator(): num(0), enom(1), reduction_size(REDUCTION_THRESHOLD) {}
+  RationalAccumulator(const Rational& r): num(r.num), enom(r.enom), reduction_size(REDUCTION_THRESHOLD) {}
+  RationalAccumulator& operator+=(const Rational& other) {
+    add(other.num, other.enom, 1);
+    return *this;
+  }
+  RationalAccumulator& operator-=(const Rational& other) {
+    add(other.num, other.enom, -1);
+    return *this;
+  }
+  Rational value() const {
+    Rational res;
+    res.num = num;
+    res.enom = enom;
+    res.normalize();
+    return res;
+  }
+  std::string toString() const { return value().toString(); }
+};
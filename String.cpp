@@ -1,38 +1,360 @@
 #include <iostream>
 #include <cstring>
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <functional>
+#ifdef STRING_COPY_ON_WRITE
+#include <atomic>
+#include <new>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define STRING_X86_SIMD 1
+#endif
+
+// Substring search over raw bytes. Needles of up to SHORT_NEEDLE bytes are found by
+// filtering candidate offsets on their first and last byte (32 offsets per step with
+// AVX2), longer ones by Boyer-Moore-Horspool. Searches return n when nothing matches.
+class StringSearcher {
+ private:
+  static const size_t SHORT_NEEDLE = 32;
+  using Scan = size_t (*)(const char*, size_t, size_t, const char*, size_t);
+  const char* needle;
+  size_t m;
+  size_t forward_shift[256];
+  size_t backward_shift[256];
+
+  static size_t nextScalar(const char* text, size_t n, size_t from, const char* needle, size_t m) {
+    while (from + m <= n) {
+      const char* candidate = static_cast<const char*>(memchr(text + from, needle[0], n - m + 1 - from));
+      if (candidate == nullptr) {
+        return n;
+      }
+      from = candidate - text;
+      if (memcmp(text + from, needle, m) == 0) {
+        return from;
+      }
+      ++from;
+    }
+    return n;
+  }
+
+  // Scans offsets end - 1 down to 0.
+  static size_t previousScalar(const char* text, size_t n, size_t end, const char* needle, size_t m) {
+    while (end > 0) {
+      --end;
+      if (text[end] == needle[0] && text[end + m - 1] == needle[m - 1] && memcmp(text + end, needle, m) == 0) {
+        return end;
+      }
+    }
+    return n;
+  }
+
+#ifdef STRING_X86_SIMD
+  __attribute__((target("avx2")))
+  static uint32_t candidatesAvx2(const char* text, size_t i, const char* needle, size_t m) {
+    __m256i first = _mm256_set1_epi8(needle[0]);
+    __m256i last = _mm256_set1_epi8(needle[m - 1]);
+    __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+    __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + m - 1));
+    __m256i both = _mm256_and_si256(_mm256_cmpeq_epi8(head, first), _mm256_cmpeq_epi8(tail, last));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(both));
+  }
+
+  __attribute__((target("avx2")))
+  static size_t nextAvx2(const char* text, size_t n, size_t from, const char* needle, size_t m) {
+    for (; from + m + 31 <= n; from += 32) {
+      for (uint32_t mask = candidatesAvx2(text, from, needle, m); mask != 0; mask &= mask - 1) {
+        size_t i = from + __builtin_ctz(mask);
+        if (memcmp(text + i + 1, needle + 1, m - 1) == 0) {
+          return i;
+        }
+      }
+    }
+    return nextScalar(text, n, from, needle, m);
+  }
+
+  __attribute__((target("avx2")))
+  static size_t previousAvx2(const char* text, size_t n, size_t end, const char* needle, size_t m) {
+    for (; end >= 32; end -= 32) {
+      for (uint32_t mask = candidatesAvx2(text, end - 32, needle, m); mask != 0; mask ^= 1u << (31 - __builtin_clz(mask))) {
+        size_t i = end - 1 - __builtin_clz(mask);
+        if (memcmp(text + i + 1, needle + 1, m - 1) == 0) {
+          return i;
+        }
+      }
+    }
+    return previousScalar(text, n, end, needle, m);
+  }
+#endif
+
+  static const Scan* scans() {
+    static const Scan selected[2] = {
+#ifdef STRING_X86_SIMD
+      __builtin_cpu_supports("avx2") ? nextAvx2 : nextScalar,
+      __builtin_cpu_supports("avx2") ? previousAvx2 : previousScalar
+#else
+      nextScalar, previousScalar
+#endif
+    };
+    return selected;
+  }
+
+ public:
+  StringSearcher(const char* needle, size_t m): needle(needle), m(m) {
+    if (m <= SHORT_NEEDLE) {
+      return;
+    }
+    for (size_t c = 0; c < 256; ++c) {
+      forward_shift[c] = m;
+      backward_shift[c] = m;
+    }
+    for (size_t i = 0; i + 1 < m; ++i) {
+      forward_shift[static_cast<unsigned char>(needle[i])] = m - 1 - i;
+    }
+    for (size_t i = m - 1; i > 0; --i) {
+      backward_shift[static_cast<unsigned char>(needle[i])] = i;
+    }
+  }
+
+  // First match starting at or after from.
+  size_t next(const char* text, size_t n, size_t from) const {
+    if (m == 0) {
+      return (from <= n ? from : n);
+    }
+    if (m > n || from > n - m) {
+      return n;
+    }
+    if (m <= SHORT_NEEDLE) {
+      return scans()[0](text, n, from, needle, m);
+    }
+    while (from <= n - m) {
+      unsigned char last = text[from + m - 1];
+      if (last == static_cast<unsigned char>(needle[m - 1]) && memcmp(text + from, needle, m - 1) == 0) {
+        return from;
+      }
+      from += forward_shift[last];
+    }
+    return n;
+  }
+
+  // Last match starting at or before from.
+  size_t previous(const char* text, size_t n, size_t from) const {
+    if (m > n) {
+      return n;
+    }
+    from = std::min(from, n - m);
+    if (m == 0) {
+      return from;
+    }
+    if (m <= SHORT_NEEDLE) {
+      return scans()[1](text, n, from + 1, needle, m);
+    }
+    while (true) {
+      unsigned char first = text[from];
+      if (first == static_cast<unsigned char>(needle[0]) && memcmp(text + from + 1, needle + 1, m - 1) == 0) {
+        return from;
+      }
+      if (from < backward_shift[first]) {
+        return n;
+      }
+      from -= backward_shift[first];
+    }
+  }
+};
+
+// Non-owning reference to size() characters starting at data(); the characters are not
+// necessarily followed by '\0'. The referenced storage must outlive the view.
+class StringView {
+ private:
+  const char* ptr;
+  size_t sz;
+ public:
+  StringView(): ptr(""), sz(0) {}
+
+  StringView(const char* string): ptr(string), sz(strlen(string)) {}
+
+  StringView(const char* string, size_t n): ptr(string), sz(n) {}
+
+  size_t size() const {
+    return sz;
+  }
+
+  size_t length() const {
+    return sz;
+  }
+
+  bool empty() const {
+    return (sz == 0);
+  }
+
+  const char* data() const {
+    return ptr;
+  }
+
+  const char& operator[](size_t i) const {
+    return ptr[i];
+  }
+
+  const char& front() const {
+    return ptr[0];
+  }
+
+  const char& back() const {
+    return ptr[sz - 1];
+  }
+
+  StringView substr(size_t start, size_t count) const {
+    return StringView(ptr + start, count);
+  }
+
+  size_t find(StringView substring, size_t from = 0) const {
+    return StringSearcher(substring.ptr, substring.sz).next(ptr, sz, from);
+  }
+
+  size_t rfind(StringView substring) const {
+    return StringSearcher(substring.ptr, substring.sz).previous(ptr, sz, sz);
+  }
+
+  // Calls callback(offset) for every occurrence of substring, overlapping ones included.
+  template<typename Callback>
+  void findAll(StringView substring, Callback callback) const {
+    StringSearcher searcher(substring.ptr, substring.sz);
+    for (size_t i = searcher.next(ptr, sz, 0); i < sz; i = searcher.next(ptr, sz, i + 1)) {
+      callback(i);
+    }
+  }
+};
 
 class String {
  private:
+  // Strings of up to LOCAL_CAPACITY characters are kept in the object itself,
+  // array then points to local and the allocator is never touched.
+  static const size_t LOCAL_CAPACITY = 15;
   size_t cap;
   size_t sz;
   char* array;
+  char local[LOCAL_CAPACITY + 1];
+  bool isLocal() const {
+    return array == local;
+  }
+#ifdef STRING_COPY_ON_WRITE
+  // Copy-on-write mode: heap buffers are preceded by a reference count and shared by
+  // copies until one of them is modified. A reference obtained through a non-const
+  // accessor must not be written through after the String has been copied.
+  using RefCount = std::atomic<size_t>;
+  static const size_t HEADER = sizeof(RefCount);
+  RefCount& refs() const {
+    return *reinterpret_cast<RefCount*>(array - HEADER);
+  }
+  static char* newBuffer(size_t n) {
+    char* block = new char[HEADER + n + 1];
+    new (block) RefCount(1);
+    return block + HEADER;
+  }
+  void releaseBuffer() {
+    if (!isLocal() && refs().fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      refs().~RefCount();
+      delete[] (array - HEADER);
+    }
+  }
+  void unshare() {
+    if (!isLocal() && refs().load(std::memory_order_acquire) != 1) {
+      char* tmp = newBuffer(cap);
+      memcpy(tmp, array, sz + 1);
+      releaseBuffer();
+      array = tmp;
+    }
+  }
+#else
+  static char* newBuffer(size_t n) {
+    return new char[n + 1];
+  }
+  void releaseBuffer() {
+    if (!isLocal()) {
+      delete[] array;
+    }
+  }
+  void unshare() {}
+#endif
+  void allocate(size_t n) {
+    if (n > LOCAL_CAPACITY) {
+      cap = n;
+      array = newBuffer(cap);
+    } else {
+      cap = LOCAL_CAPACITY;
+      array = local;
+    }
+  }
   void relocate(size_t new_cap) {
-    char* tmp = new char[new_cap + 1];
-    memcpy(tmp, array, sz);
-    cap = new_cap;
-    delete[] array;
-    array = tmp;
+    char* tmp = (new_cap > LOCAL_CAPACITY ? newBuffer(new_cap) : local);
+    if (tmp != array) {
+      memcpy(tmp, array, sz);
+      releaseBuffer();
+      array = tmp;
+    }
+    cap = (new_cap > LOCAL_CAPACITY ? new_cap : LOCAL_CAPACITY);
   }
   void swap(String& string) {
+    bool local1 = isLocal();
+    bool local2 = string.isLocal();
+    std::swap(local, string.local);
     std::swap(array, string.array);
+    if (local1) {
+      string.array = string.local;
+    }
+    if (local2) {
+      array = local;
+    }
     std::swap(sz, string.sz);
     std::swap(cap, string.cap);
   }
  public:
-  String(const char* string): cap(strlen(string)), sz(strlen(string)), array(new char[cap + 1]) {
-    memcpy(array, string, cap + 1);
+  String(const char* string): sz(strlen(string)) {
+    allocate(sz);
+    memcpy(array, string, sz + 1);
   }
 
-  String(size_t n, char c): cap(n), sz(n), array(new char[cap + 1]) {
+  String(const char* string, size_t n): sz(n) {
+    allocate(sz);
+    memcpy(array, string, sz);
+    array[sz] = '\0';
+  }
+
+  explicit String(StringView view): String(view.data(), view.size()) {}
+
+  String(size_t n, char c): sz(n) {
+    allocate(sz);
     memset(array, c, n);
     array[n] = '\0';
   }
 
-  String(): cap(0), sz(0), array(new char[cap + 1]) {
+  String(): cap(LOCAL_CAPACITY), sz(0), array(local) {
     array[0] = '\0';
   }
-  String(const String& string): cap(string.cap), sz(string.sz), array(new char[cap + 1]) {
-    memcpy(array, string.array, cap + 1);
+  String(const String& string): sz(string.sz) {
+#ifdef STRING_COPY_ON_WRITE
+    if (!string.isLocal()) {
+      cap = string.cap;
+      array = string.array;
+      refs().fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+#endif
+    allocate(sz);
+    memcpy(array, string.array, sz + 1);
+  }
+
+  String(String&& string) noexcept: cap(string.cap), sz(string.sz), array(string.array) {
+    if (string.isLocal()) {
+      array = local;
+      memcpy(local, string.local, sz + 1);
+    }
+    string.cap = LOCAL_CAPACITY;
+    string.sz = 0;
+    string.array = string.local;
+    string.local[0] = '\0';
   }
 
   size_t size() const {
@@ -43,16 +365,96 @@ class String {
     return cap;
   }
 
-  String& operator=(String string) {
+  String& operator=(const String& string) {
+    if (this == &string) {
+      return *this;
+    }
+#ifdef STRING_COPY_ON_WRITE
+    if (!string.isLocal()) {
+      String copy = string;
+      swap(copy);
+      return *this;
+    }
+#endif
+    if (string.sz > cap) {
+      String copy = string;
+      swap(copy);
+      return *this;
+    }
+    unshare();
+    sz = string.sz;
+    memcpy(array, string.array, sz + 1);
+    return *this;
+  }
+
+  String& operator=(String&& string) noexcept {
     swap(string);
     return *this;
   }
 
+  void reserve(size_t n) {
+    if (n > cap) {
+      relocate(n);
+      array[sz] = '\0';
+    }
+  }
+
+  // Lengths and appends of the pieces accepted by concat().
+  static size_t pieceLength(const String& string) {
+    return string.sz;
+  }
+
+  static size_t pieceLength(StringView view) {
+    return view.size();
+  }
+
+  static size_t pieceLength(const char* string) {
+    return strlen(string);
+  }
+
+  static size_t pieceLength(char) {
+    return 1;
+  }
+
+  void append(const char* string, size_t n) {
+    // string may point into this String, whose buffer can move below.
+    std::less_equal<const char*> before;
+    bool aliased = before(array, string) && before(string, array + sz);
+    size_t offset = string - array;
+    unshare();
+    if (sz + n > cap) {
+      relocate(2 * (sz + n));
+    }
+    if (aliased) {
+      string = array + offset;
+    }
+    memcpy(array + sz, string, n);
+    sz += n;
+    array[sz] = '\0';
+  }
+
+  void append(const String& string) {
+    append(string.array, string.sz);
+  }
+
+  void append(StringView view) {
+    append(view.data(), view.size());
+  }
+
+  void append(const char* string) {
+    append(string, strlen(string));
+  }
+
+  void append(char c) {
+    push_back(c);
+  }
+
   const char& operator[](size_t i) const {
     return array[i];
   }
 
   char& operator[](size_t i) {
+    unshare();
     return array[i];
   }
 
@@ -61,6 +463,7 @@ class String {
   }
 
   void push_back(char c) {
+    unshare();
     if (sz + 1 > cap) {
       relocate(2 * cap + 1);
     }
@@ -69,14 +472,17 @@ class String {
   }
 
   void pop_back() {
+    unshare();
     array[--sz] = '\0';
   }
 
   char& front() {
+    unshare();
     return array[0];
   }
 
   char& back() {
+    unshare();
     return array[sz - 1];
   }
 
@@ -93,39 +499,35 @@ class String {
     return *this;
   }
 
-  String& operator+=(const String& string) {
-    if (sz + string.sz > cap) {
-      relocate(2 * (sz + string.sz));
-    }
-    memcpy(array + sz, string.array, string.sz);
-    sz += string.sz;
-    array[sz] = '\0';
+  String& operator+=(StringView view) {
+    append(view.data(), view.size());
     return *this;
   }
 
-  size_t find(const String& substring) const {
-    for (size_t i = 0; i <= sz - substring.sz; ++i) {
-      if (memcmp(array + i, substring.data(), substring.sz) == 0) {
-        return i;
-      }
-    }
-    return sz;
+  operator StringView() const {
+    return StringView(array, sz);
   }
 
-  size_t rfind(const String& substring) const {
-    for (size_t i = 0; i <= sz - substring.sz; ++i) {
-      if (memcmp(array + (sz - substring.sz - i), substring.data(), substring.sz) == 0) {
-        return sz - substring.sz - i;
-      }
-    }
-    return sz;
+  size_t find(StringView substring, size_t from = 0) const {
+    return StringView(*this).find(substring, from);
+  }
+
+  size_t rfind(StringView substring) const {
+    return StringView(*this).rfind(substring);
+  }
+
+  template<typename Callback>
+  void findAll(StringView substring, Callback callback) const {
+    StringView(*this).findAll(substring, callback);
   }
 
   String substr(size_t start, size_t count) const {
-    String result(count, '.');
-    memcpy(result.array, array + start, count);
-    result.array[count] = '\0';
-    return result;
+    return String(array + start, count);
+  }
+
+  // Same characters as substr(start, count), without copying them.
+  StringView view(size_t start, size_t count) const {
+    return StringView(array + start, count);
   }
 
   bool empty() {
@@ -133,6 +535,7 @@ class String {
   }
 
   void clear() {
+    unshare();
     sz = 0;
     array[0] = '\0';
   }
@@ -143,6 +546,7 @@ class String {
   }
 
   char* data() {
+    unshare();
     return array;
   }
 
@@ -150,53 +554,69 @@ class String {
     return array;
   }
 
+  friend std::istream& readAll(std::istream& in, String& string);
+
   ~String() {
-    delete[] array;
+    releaseBuffer();
   }
 };
 
-String operator+(const String& string1, const String& string2) {
-  String result = string1;
-  result += string2;
+// Concatenates Strings, C strings and characters, allocating the result exactly once.
+template<typename... Pieces>
+String concat(const Pieces& ... pieces) {
+  String result;
+  result.reserve((String::pieceLength(pieces) + ... + 0));
+  (result.append(pieces), ...);
   return result;
 }
 
+String operator+(const String& string1, const String& string2) {
+  return concat(string1, string2);
+}
+
+String operator+(String&& string1, const String& string2) {
+  string1 += string2;
+  return std::move(string1);
+}
+
 String operator+(const String& string, char c) {
-  String result = string;
-  result += c;
-  return result;
+  return concat(string, c);
 }
 
-String operator+(char c, String& string) {
-  String result(1, c);
-  result += string;
-  return result;
+String operator+(String&& string, char c) {
+  string += c;
+  return std::move(string);
+}
+
+String operator+(char c, const String& string) {
+  return concat(c, string);
 }
 
-bool operator<(const String& string1, const String& string2) {
-  return memcmp(string1.data(), string2.data(), std::max(string1.size(), string2.size())) < 0;
+bool operator<(StringView string1, StringView string2) {
+  int order = memcmp(string1.data(), string2.data(), std::min(string1.size(), string2.size()));
+  return order < 0 || (order == 0 && string1.size() < string2.size());
 }
 
-bool operator>=(const String& string1, const String& string2) {
+bool operator>=(StringView string1, StringView string2) {
   return !(string1 < string2);
 }
 
-bool operator>(const String& string1, const String& string2) {
+bool operator>(StringView string1, StringView string2) {
   return string2 < string1;
 }
 
-bool operator<=(const String& string1, const String& string2) {
+bool operator<=(StringView string1, StringView string2) {
   return !(string1 > string2);
 }
 
-bool operator==(const String& string1, const String& string2) {
+bool operator==(StringView string1, StringView string2) {
   if (string1.size() != string2.size()) {
     return false;
   }
   return memcmp(string1.data(), string2.data(), string1.size()) == 0;
 }
 
-bool operator!=(const String& string1, const String& string2) {
+bool operator!=(StringView string1, StringView string2) {
   return !(string1 == string2);
 }
 
@@ -205,12 +625,274 @@ std::ostream& operator<<(std::ostream& out, const String& string) {
   return out;
 }
 
+std::ostream& operator<<(std::ostream& out, StringView view) {
+  out.write(view.data(), view.size());
+  return out;
+}
+
+// Gives access to the get area of a stream buffer, so that extraction can copy whole
+// runs of buffered characters instead of going through the stream one character at a time.
+class StreamBufferAccess : public std::streambuf {
+ public:
+  static const char* begin(std::streambuf* buffer) {
+    return (buffer->*&StreamBufferAccess::gptr)();
+  }
+
+  static const char* end(std::streambuf* buffer) {
+    return (buffer->*&StreamBufferAccess::egptr)();
+  }
+
+  static void advance(std::streambuf* buffer, size_t n) {
+    (buffer->*&StreamBufferAccess::gbump)(static_cast<int>(n));
+  }
+};
+
+// Appends characters from in to string until stop(c) holds for a character c, which is
+// left in the stream. Returns true if that character was found before the end of stream.
+template<typename Stop>
+bool extractUntil(std::istream& in, String& string, Stop stop) {
+  std::streambuf* buffer = in.rdbuf();
+  while (true) {
+    const char* begin = StreamBufferAccess::begin(buffer);
+    const char* end = StreamBufferAccess::end(buffer);
+    if (begin == end) {
+      int c = buffer->sgetc();
+      if (c == std::char_traits<char>::eof()) {
+        in.setstate(std::ios::eofbit);
+        return false;
+      }
+      if (StreamBufferAccess::begin(buffer) == StreamBufferAccess::end(buffer)) {
+        // Unbuffered stream: fall back to one character at a time.
+        if (stop(static_cast<char>(c))) {
+          return true;
+        }
+        string.push_back(static_cast<char>(c));
+        buffer->sbumpc();
+      }
+      continue;
+    }
+    const char* run_end = begin;
+    while (run_end != end && !stop(*run_end)) {
+      ++run_end;
+    }
+    string.append(begin, run_end - begin);
+    StreamBufferAccess::advance(buffer, run_end - begin);
+    if (run_end != end) {
+      return true;
+    }
+  }
+}
+
 std::istream& operator>>(std::istream& in, String& string) {
-  while (std::isspace(in.peek()) && !in.eof()) {
-    in.get();
+  std::istream::sentry sentry(in);
+  if (sentry) {
+    extractUntil(in, string, [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; });
+  }
+  return in;
+}
+
+// Replaces string with the next line of in; the delimiter is consumed but not stored.
+std::istream& getline(std::istream& in, String& string, char delimiter = '\n') {
+  string.clear();
+  std::istream::sentry sentry(in, true);
+  if (!sentry) {
+    return in;
+  }
+  if (extractUntil(in, string, [delimiter](char c) { return c == delimiter; })) {
+    in.rdbuf()->sbumpc();
+  } else if (string.empty()) {
+    in.setstate(std::ios::failbit);
   }
-  while (!std::isspace(in.peek()) && !in.eof()) {
-    string.push_back(in.get());
+  return in;
+}
+
+// Appends everything left in in to string, reading straight into its storage.
+std::istream& readAll(std::istream& in, String& string) {
+  static const size_t CHUNK = 1 << 16;
+  std::istream::sentry sentry(in, true);
+  if (!sentry) {
+    return in;
+  }
+  string.unshare();
+  while (true) {
+    if (string.cap - string.sz < CHUNK) {
+      string.relocate(2 * string.cap + CHUNK);
+    }
+    std::streamsize wanted = string.cap - string.sz;
+    std::streamsize got = in.rdbuf()->sgetn(string.array + string.sz, wanted);
+    string.sz += got;
+    if (got < wanted) {
+      break;
+    }
   }
+  string.array[string.sz] = '\0';
+  in.setstate(std::ios::eofbit);
   return in;
 }
+
+// 64-bit wyhash of n bytes.
+uint64_t hashBytes(const char* data, size_t n, uint64_t seed = 0) {
+  static const uint64_t SECRET[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+                                     0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
+  auto mix = [](uint64_t a, uint64_t b) {
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+  };
+  auto read64 = [](const char* p) {
+    uint64_t value;
+    memcpy(&value, p, 8);
+    return value;
+  };
+  auto read32 = [](const char* p) {
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return static_cast<uint64_t>(value);
+  };
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+  seed ^= mix(seed ^ SECRET[0], SECRET[1]);
+  uint64_t a = 0;
+  uint64_t b = 0;
+  if (n <= 16) {
+    if (n >= 4) {
+      size_t middle = (n >> 3) << 2;
+      a = (read32(data) << 32) | read32(data + middle);
+      b = (read32(data + n - 4) << 32) | read32(data + n - 4 - middle);
+    } else if (n > 0) {
+      a = (static_cast<uint64_t>(bytes[0]) << 16) | (static_cast<uint64_t>(bytes[n >> 1]) << 8) | bytes[n - 1];
+    }
+  } else {
+    size_t left = n;
+    if (left > 48) {
+      uint64_t seed1 = seed;
+      uint64_t seed2 = seed;
+      do {
+        seed = mix(read64(data) ^ SECRET[1], read64(data + 8) ^ seed);
+        seed1 = mix(read64(data + 16) ^ SECRET[2], read64(data + 24) ^ seed1);
+        seed2 = mix(read64(data + 32) ^ SECRET[3], read64(data + 40) ^ seed2);
+        data += 48;
+        left -= 48;
+      } while (left > 48);
+      seed ^= seed1 ^ seed2;
+    }
+    while (left > 16) {
+      seed = mix(read64(data) ^ SECRET[1], read64(data + 8) ^ seed);
+      data += 16;
+      left -= 16;
+    }
+    a = read64(data + left - 16);
+    b = read64(data + left - 8);
+  }
+  __uint128_t product = static_cast<__uint128_t>(a ^ SECRET[1]) * (b ^ seed);
+  a = static_cast<uint64_t>(product);
+  b = static_cast<uint64_t>(product >> 64);
+  return mix(a ^ SECRET[0] ^ n, b ^ SECRET[1]);
+}
+
+namespace std {
+template<>
+struct hash<StringView> {
+  size_t operator()(StringView view) const {
+    return hashBytes(view.data(), view.size());
+  }
+};
+
+template<>
+struct hash<String> {
+  size_t operator()(const String& string) const {
+    return hashBytes(string.data(), string.size());
+  }
+};
+}
+
+// Interner: equal strings get the same Handle, so handles compare by pointer and carry
+// their hash. Interned strings live as long as the pool.
+class StringPool {
+ private:
+  struct Entry {
+    String value;
+    uint64_t hash;
+  };
+  std::deque<Entry> entries;
+  std::vector<const Entry*> table = std::vector<const Entry*>(16, nullptr);
+
+  void grow() {
+    std::vector<const Entry*> bigger(2 * table.size(), nullptr);
+    size_t mask = bigger.size() - 1;
+    for (const Entry* entry : table) {
+      if (entry != nullptr) {
+        size_t i = entry->hash & mask;
+        while (bigger[i] != nullptr) {
+          i = (i + 1) & mask;
+        }
+        bigger[i] = entry;
+      }
+    }
+    table.swap(bigger);
+  }
+ public:
+  StringPool() = default;
+  // The table points into entries, so a copy would refer to the original's strings.
+  StringPool(const StringPool&) = delete;
+  StringPool& operator=(const StringPool&) = delete;
+  StringPool(StringPool&&) = default;
+  StringPool& operator=(StringPool&&) = default;
+
+  class Handle {
+   private:
+    const Entry* entry = nullptr;
+    friend class StringPool;
+    explicit Handle(const Entry* entry): entry(entry) {}
+   public:
+    Handle() = default;
+
+    size_t hash() const {
+      return entry->hash;
+    }
+
+    const String& string() const {
+      return entry->value;
+    }
+
+    operator StringView() const {
+      return entry->value;
+    }
+
+    bool operator==(Handle other) const {
+      return entry == other.entry;
+    }
+
+    bool operator!=(Handle other) const {
+      return entry != other.entry;
+    }
+  };
+
+  Handle intern(StringView string) {
+    uint64_t hash = hashBytes(string.data(), string.size());
+    size_t mask = table.size() - 1;
+    size_t i = hash & mask;
+    for (; table[i] != nullptr; i = (i + 1) & mask) {
+      if (table[i]->hash == hash && table[i]->value == string) {
+        return Handle(table[i]);
+      }
+    }
+    entries.push_back(Entry{String(string), hash});
+    table[i] = &entries.back();
+    if (2 * entries.size() > table.size()) {
+      grow();
+    }
+    return Handle(&entries.back());
+  }
+
+  size_t size() const {
+    return entries.size();
+  }
+};
+
+namespace std {
+template<>
+struct hash<StringPool::Handle> {
+  size_t operator()(StringPool::Handle handle) const {
+    return handle.hash();
+  }
+};
+}
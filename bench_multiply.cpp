@@ -0,0 +1,170 @@
+// Multiplication tier benchmark: times each BigInteger multiplication tier on equal-sized
+// random operands, next to the original base-1e9 schoolbook loop, and reports where each
+// tier overtakes the previous one. KARATSUBA_THRESHOLD, NTT_THRESHOLD and TOOM3_THRESHOLD
+// in BigInteger.cpp are taken from these crossovers.
+//
+//   g++ -std=c++17 -O2 -pthread bench_multiply.cpp -o bench_multiply
+//   ./bench_multiply [max_limbs]
+//
+// Measured on one core (x86-64, g++ 12 -O2), equal n-limb operands, best of five:
+//   n        baseline  schoolbook  karatsuba   toom3      ntt   (microseconds)
+//   41           4.4        1.3        1.2       -         -
+//   457        634.6      301.4       82.2       -         -
+//   1738      8397.0     2121.0      468.0     542.0     696.0
+//   6626          -          -      3907.4    4656.0    3620.3
+//   8282          -          -      6241.3    7159.8    8706.2
+//   12940         -          -     10864.6   12606.7    7175.3
+//   25272         -          -     32585.5   35945.0   14876.5
+// Crossovers:
+//   a Karatsuba step beats schoolbook from about 33 limbs (KARATSUBA_THRESHOLD = 40);
+//   NTT beats Karatsuba from about 6600 limbs except just past each power-of-two transform
+//   length (n + m slightly above 2^14 costs a 2^15 transform), and for good from about
+//   10000 limbs (NTT_THRESHOLD = 7000);
+//   Toom-3 over the other tiers stays within noise of Karatsuba and never beats NTT, so it
+//   is only dispatched where NTT cannot run, past NTT_MAX_LENGTH (n + m > 2^23 limbs);
+//   TOOM3_THRESHOLD = 8000 only keeps it above the NTT crossover.
+#include "BigInteger.cpp"
+#include <chrono>
+#include <random>
+#include <cstdio>
+
+struct MultiplyBenchmark {
+  static std::mt19937 rng;
+
+  static LimbVector randomLimbs(int n) {
+    LimbVector limbs(n);
+    for (int i = 0; i < n; ++i) { limbs[i] = static_cast<uint32_t>(rng()); }
+    limbs[n - 1] |= 1u << 31;
+    return limbs;
+  }
+  // Same magnitude in the base-1e9 digits the original operator*= worked on.
+  static std::vector<long long> decimalDigits(const LimbVector& limbs) {
+    std::string text = BigInteger::fromLimbs(limbs.data(), static_cast<int>(limbs.size())).toString();
+    std::vector<long long> digits;
+    for (int end = static_cast<int>(text.size()); end > 0; end -= 9) {
+      int begin = std::max(0, end - 9);
+      digits.push_back(std::stoll(text.substr(begin, end - begin)));
+    }
+    return digits;
+  }
+  // operator*= as it was before the multiplication tiers were added.
+  static std::vector<long long> baseline(const std::vector<long long>& a, const std::vector<long long>& b) {
+    const long long mod = 1'000'000'000;
+    std::vector<long long> res(a.size() + b.size() + 1);
+    for (int i = 0; i < static_cast<int>(a.size()); ++i) {
+      long long carry = 0;
+      for (int j = 0; j < static_cast<int>(b.size()) || carry; ++j) {
+        long long cur = res[i + j] + a[i] * (j < static_cast<int>(b.size()) ? b[j] : 0) + carry;
+        res[i + j] = cur % mod;
+        carry = cur / mod;
+      }
+    }
+    return res;
+  }
+  // One Karatsuba step over schoolbook halves: the choice KARATSUBA_THRESHOLD makes.
+  static void karatsubaStep(const uint32_t* a, const uint32_t* b, int n, uint32_t* res, uint32_t* scratch) {
+    int k = n / 2, h = n - k;
+    BigInteger::mulSchoolbook(a, k, b, k, res);
+    BigInteger::mulSchoolbook(a + k, h, b + k, h, res + 2 * k);
+    uint32_t* sum_a = scratch;
+    uint32_t* sum_b = sum_a + h + 1;
+    uint32_t* mid = sum_b + h + 1;
+    std::copy(a + k, a + n, sum_a);
+    std::copy(b + k, b + n, sum_b);
+    sum_a[h] = BigInteger::addTo(sum_a, h, a, k);
+    sum_b[h] = BigInteger::addTo(sum_b, h, b, k);
+    BigInteger::mulSchoolbook(sum_a, h + 1, sum_b, h + 1, mid);
+    BigInteger::subFrom(mid, 2 * h + 2, res, 2 * k);
+    BigInteger::subFrom(mid, 2 * h + 2, res + 2 * k, 2 * h);
+    int len = 2 * h + 2;
+    while (len > 0 && mid[len - 1] == 0) { --len; }
+    BigInteger::addTo(res + k, 2 * n - k, mid, len);
+  }
+  // Smallest measured size from which the candidate stayed faster than the incumbent.
+  static int crossover(const std::vector<int>& sizes, const std::vector<double>& candidate,
+                       const std::vector<double>& incumbent) {
+    int from = 0;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      if (candidate[i] < 0 || incumbent[i] < 0) { continue; }
+      if (candidate[i] >= incumbent[i]) {
+        from = 0;
+      } else if (from == 0) {
+        from = sizes[i];
+      }
+    }
+    return from;
+  }
+  // Best-of-five microseconds per call of f, repeating f until each round takes ~20ms.
+  template <typename F>
+  static double time(F f) {
+    using Clock = std::chrono::steady_clock;
+    int reps = 1;
+    for (;;) {
+      Clock::time_point start = Clock::now();
+      for (int r = 0; r < reps; ++r) { f(); }
+      if (Clock::now() - start > std::chrono::milliseconds(20) || reps >= (1 << 20)) { break; }
+      reps *= 2;
+    }
+    double best = 1e300;
+    for (int round = 0; round < 5; ++round) {
+      Clock::time_point start = Clock::now();
+      for (int r = 0; r < reps; ++r) { f(); }
+      best = std::min(best, std::chrono::duration<double, std::micro>(Clock::now() - start).count() / reps);
+    }
+    return best;
+  }
+  static void run(int max_limbs) {
+    const double skipped = -1;
+    std::vector<int> sizes;
+    std::vector<double> school, step, kara, toom, ntt;
+    std::printf("%8s %11s %11s %11s %11s %11s %11s %11s\n", "limbs", "baseline", "schoolbook", "kara-step",
+                "karatsuba", "toom3", "ntt", "operator*");
+    for (int n = 8; n <= max_limbs; n += std::max(1, n / 4)) {
+      LimbVector a = randomLimbs(n), b = randomLimbs(n), res(2 * n + 2), scratch(4 * n + 8);
+      BigInteger x = BigInteger::fromLimbs(a.data(), n), y = BigInteger::fromLimbs(b.data(), n);
+      double base = skipped;
+      sizes.push_back(n);
+      school.push_back(skipped);
+      step.push_back(skipped);
+      kara.push_back(skipped);
+      toom.push_back(skipped);
+      ntt.push_back(skipped);
+      if (n <= 2000) {
+        std::vector<long long> da = decimalDigits(a), db = decimalDigits(b);
+        base = time([&] { baseline(da, db); });
+        school.back() = time([&] { BigInteger::mulSchoolbook(a.data(), n, b.data(), n, res.data()); });
+        step.back() = time([&] { karatsubaStep(a.data(), b.data(), n, res.data(), scratch.data()); });
+      }
+      if (n >= BigInteger::KARATSUBA_THRESHOLD) {
+        LimbVector karatsuba_scratch(BigInteger::karatsubaScratch(n) + 1);
+        kara.back() = time([&] {
+          BigInteger::mulKaratsuba(a.data(), b.data(), n, res.data(), karatsuba_scratch.data());
+        });
+      }
+      if (n >= 500) {
+        toom.back() = time([&] { BigInteger::toomCook3(x, y); });
+        ntt.back() = time([&] { BigInteger::multiplyNtt(a, b); });
+      }
+      double full = time([&] { x * y; });
+      std::printf("%8d %11.1f %11.1f %11.1f %11.1f %11.1f %11.1f %11.1f\n", n, base, school.back(), step.back(),
+                  kara.back(), toom.back(), ntt.back(), full);
+    }
+    std::printf("\nmicroseconds per product; -1 = not timed at this size\n");
+    std::printf("karatsuba step < schoolbook from %d limbs (KARATSUBA_THRESHOLD = %d)\n",
+                crossover(sizes, step, school), BigInteger::KARATSUBA_THRESHOLD);
+    std::printf("toom3 < karatsuba from %d limbs (TOOM3_THRESHOLD = %d)\n", crossover(sizes, toom, kara),
+                BigInteger::TOOM3_THRESHOLD);
+    std::vector<double> best_classical(sizes.size());
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      best_classical[i] = toom[i] < 0 ? kara[i] : kara[i] < 0 ? toom[i] : std::min(kara[i], toom[i]);
+    }
+    std::printf("ntt < min(karatsuba, toom3) from %d limbs (NTT_THRESHOLD = %d, NTT_MAX_LENGTH = %d)\n",
+                crossover(sizes, ntt, best_classical), BigInteger::NTT_THRESHOLD, BigInteger::NTT_MAX_LENGTH);
+    std::printf("0 = no lasting crossover up to %d limbs\n", max_limbs);
+  }
+};
+std::mt19937 MultiplyBenchmark::rng(2024);
+
+int main(int argc, char** argv) {
+  MultiplyBenchmark::run(argc > 1 ? std::atoi(argv[1]) : 40000);
+}